@@ -0,0 +1,145 @@
+#ifndef __BENCHMARK_H__
+#define __BENCHMARK_H__
+
+#include <glad/gl.h>
+
+#include <string>
+#include <vector>
+
+// @brief Settings of a headless benchmark run, from the command line
+struct BenchmarkOptions {
+    bool headless = false;                                  // --headless: render offscreen instead of opening a window
+    bool jobBenchmark = false;                              // --job-benchmark: measure how culling scales with threads, then exit
+    bool cullBenchmark = false;                             // --cull-benchmark: measure frustum test throughput on one thread, then exit
+    bool transformBenchmark = false;                        // --transform-benchmark: measure instance matrix throughput on one thread, then exit
+    bool sortBenchmark = false;                             // --sort-benchmark: measure radix sort throughput on one thread, then exit
+    bool uniformBenchmark = false;                          // --uniform-benchmark: measure uniform location lookups in a headless context, then exit
+    int frames = 600;                                       // --frames N: frames to render
+    int warmupFrames = 30;                                  // --warmup N: frames rendered before measuring
+    int width = 1280;                                       // --width W: render target width
+    int height = 720;                                       // --height H: render target height
+    double timestep = 1.0 / 60.0;                           // --timestep S: simulated seconds per frame
+    double budget = 16.6;                                   // --budget MS: GPU time per frame for dynamic resolution, 0 for full
+                                                            // resolution; headless runs default to 0 so the pixel load is fixed
+    std::string output;                                     // --output PATH: summary file, CSV if it ends in .csv, JSON otherwise
+    std::string trace;                                      // --trace PATH: capture a profiler trace after warm-up (ENABLE_PROFILER builds)
+    int traceFrames = 120;                                  // --trace-frames N: frames in a trace, also used by F2 in a window
+};
+
+// @brief Parse the benchmark flags; prints usage and returns false on an unknown or malformed flag
+// @param argc    Argument count from main
+// @param argv    Arguments from main
+// @param options Options to fill, defaults are kept for flags not given
+bool parseBenchmarkOptions(int argc, char** argv, BenchmarkOptions& options);
+
+// @brief GPU time of whole frames from GL_TIME_ELAPSED queries. Several queries are kept in
+//        flight and read once available, so measuring does not stall the pipeline. A frame whose
+//        query is still pending when its query comes round again gets no result and is counted.
+class GPUFrameTimer {
+public:
+
+    // Queries in flight; results arrive this many frames late at most
+    static const unsigned int QUERY_COUNT = 4;
+
+    GPUFrameTimer();
+
+    // @brief Start timing a frame, dropping the oldest query if it is still pending
+    // @param frameIndex Frame being timed, returned with its result
+    void begin(int frameIndex);
+
+    // @brief Stop timing the current frame
+    void end();
+
+    // @brief Move every available result to the back of two lists
+    // @param milliseconds Receives the GPU time of each frame
+    // @param frames       Receives the index of each of those frames
+    // @param wait         Block until every pending query has a result, e.g. after the last frame
+    void collect(std::vector<double>& milliseconds, std::vector<int>& frames, bool wait = false);
+
+    // @brief Number of frames whose query was dropped before its result was read
+    unsigned int dropped() const { return _dropped; }
+
+    // @brief Delete the queries
+    void deleteQueries();
+
+private:
+    unsigned int _queries[QUERY_COUNT];
+    bool _pending[QUERY_COUNT] = {};
+    int _frames[QUERY_COUNT] = {};                          // frame each query times
+    unsigned int _next = 0;                                 // query the next frame uses
+    unsigned int _oldest = 0;                               // oldest query that may be pending
+    unsigned int _dropped = 0;
+};
+
+// @brief Frame time samples of a run and their summary
+class BenchmarkReport {
+public:
+
+    // @brief Summary of one series of samples, in milliseconds
+    struct Summary {
+        size_t count = 0;
+        double mean = 0.0;
+        double min = 0.0;
+        double max = 0.0;
+        double p50 = 0.0;
+        double p95 = 0.0;
+        double p99 = 0.0;
+    };
+
+    // CPU time per frame, in milliseconds
+    std::vector<double> cpuMilliseconds;
+
+    // GPU time per frame, in milliseconds
+    std::vector<double> gpuMilliseconds;
+
+    // Dynamic resolution scale at the end of the run, 1 at full resolution
+    float resolutionScale = 1.0f;
+
+    // @brief Summarize a series with nearest-rank percentiles
+    static Summary summarize(const std::vector<double>& samples);
+
+    // @brief Print the summary to stdout
+    // @param options Settings of the run
+    void print(const BenchmarkOptions& options) const;
+
+    // @brief Write the summary, as CSV if the path ends in .csv and JSON otherwise
+    // @param path    File to write
+    // @param options Settings of the run, recorded alongside the results
+    bool write(const std::string& path, const BenchmarkOptions& options) const;
+};
+
+// @brief Make free text, e.g. a renderer string or a profiler scope name, safe inside a JSON
+//        string: quotes and backslashes are escaped and control characters dropped
+std::string escapeJson(const char* text);
+
+// @brief Time frustum culling of a synthetic scene on one thread up to every hardware thread and
+//        print the speed-up of each thread count. Restarts the job system for each count and
+//        leaves it stopped; needs no GL context.
+// @param entityCount Entities in the scene, e.g. 1000000
+void runJobScalingBenchmark(size_t entityCount);
+
+// @brief Time the frustum culling kernels over random spheres and boxes on the calling thread and
+//        print the tests per second of the SIMD and scalar paths
+// @param objectCount Objects per run, e.g. 1000000
+void runCullingBenchmark(size_t objectCount);
+
+// @brief Time TransformBatch::computeInstances against computeInstancesScalar and per-instance
+//        glm (translate * mat4_cast * scale, normal matrix by inverse) on the calling thread and
+//        print the model and normal matrix pairs per second of each
+// @param instanceCount Instances per run, e.g. 1000000
+void runTransformBenchmark(size_t instanceCount);
+
+// @brief Time radixSortKeys over random keys and over keys shaped like draw keys on the calling
+//        thread and print the keys sorted per second, with std::sort as a reference
+// @param keyCount Keys per run, e.g. 1000000
+void runSortBenchmark(size_t keyCount);
+
+// @brief Build the lit shader in a headless context, or a hidden window without EGL, and time
+//        uniform location lookups through a UniformTable, by precomputed hash and by name, against
+//        std::unordered_map and the driver
+// @param vertexPath   Path to the lit vertex shader
+// @param fragmentPath Path to the lit fragment shader
+// @param lookupCount  Lookups per run, e.g. 1000000
+void runUniformBenchmark(const char* vertexPath, const char* fragmentPath, size_t lookupCount);
+
+#endif // __BENCHMARK_H__
@@ -1,21 +1,21 @@
 #ifndef __CAMERA_H__
 #define __CAMERA_H__
 
-#include <glad/gl.h>
-#include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <stdint.h>
+
+#include "FrustumCulling.h"
+#include "InputQueue.h"
+
+/// @brief First person camera. Its state only changes through the setters and processEvents,
+///        each of which bumps version() when something actually moved; the matrices and frustum
+///        derived from it are recomputed on first use after a change. Not thread safe, the
+///        getters update the cache.
 class Camera {
 public:
 
-	// Camera attributes
-	glm::vec3 CameraPos;
-	glm::vec3 CameraFront; 
-	glm::vec3 CameraUp;
-	glm::vec3 CameraRight;
-	glm::vec3 WorldUp;
-
 	/// @brief Constructs a new Camera object
 	/// @param position The initial position of the camera
 	/// @param up The up vector of the camera
@@ -24,30 +24,88 @@ public:
 	/// @param lastX The initial x-coordinate of the mouse cursor
 	/// @param lastY The initial y-coordinate of the mouse cursor
 	Camera(glm::vec3 position, glm::vec3 up, float yaw, float pitch, float lastX, float lastY);
-	
-	/// @brief Handles mouse movement input
-	/// @param window Pointer to the GLFW window 
-	/// @param xpos The new x-coordinate of the mouse cursor
-	/// @param ypos The new y-coordinate of the mouse cursor
-	void mouseCallback(GLFWwindow* window, double xpos, double ypos);
-
-	/// @brief Handles mouse scroll input for zooming
-	/// @param window Pointer to the GLFW window
-	/// @param xoffset The scroll offset in the x-direction
-	/// @param yoffset The scroll offset in the y-direction
-	void scrollCallback(GLFWwindow* window, double xoffset, double yoffset);
-
-	/// @brief Calculates and returns the view matrix using the LookAt function
-	glm::mat4 calculateLookAt();
+
+	/// @brief Applies the queued cursor and scroll events up to a time: the mouse movement is
+	///        summed and turned into one orientation change, the scroll offsets into one zoom change
+	/// @param events The queue to read, as its consumer
+	/// @param until Time the simulation step ends at, on the clock of the events; later events
+	///        stay queued for the next step
+	void processEvents(InputQueue& events, double until);
+
+	/// @brief Places the camera at a world space position
+	/// @param position The new position of the camera
+	void setPosition(const glm::vec3& position);
+
+	/// @brief Sets the width over height ratio of the projection, e.g. after a resize
+	/// @param aspect The aspect ratio of the output
+	void setAspect(float aspect);
+
+	/// @brief Sets the distances of the near and far clip planes
+	/// @param nearPlane Distance to the near plane
+	/// @param farPlane Distance to the far plane
+	void setClipPlanes(float nearPlane, float farPlane);
+
+	/// @brief Returns the world space position of the camera
+	const glm::vec3& getPosition() const { return _position; }
+
+	/// @brief Returns the direction the camera looks in
+	const glm::vec3& getFront() const { return _front; }
+
+	/// @brief Returns the up vector of the camera
+	const glm::vec3& getUp() const { return _up; }
+
+	/// @brief Returns the vector pointing to the right of the camera
+	const glm::vec3& getRight() const { return _right; }
 
 	/// @brief Returns the current zoom (FOV) value
 	float getZoom() const { return _zoom; }
 
+	/// @brief Returns a counter bumped by every change to the camera, for caches of anything derived from it
+	uint64_t version() const { return _version; }
+
+	/// @brief Returns the view matrix, from the LookAt function
+	const glm::mat4& getView() const;
+
+	/// @brief Returns the perspective projection matrix
+	const glm::mat4& getProjection() const;
+
+	/// @brief Returns the projection times the view matrix
+	const glm::mat4& getViewProjection() const;
+
+	/// @brief Returns the inverse of the view projection matrix, from clip to world space
+	const glm::mat4& getInverseViewProjection() const;
+
+	/// @brief Returns the planes of the view frustum
+	const Frustum& getFrustum() const;
+
 private:
 
-	// Last mouse positions
-	float _lastX;
-	float _lastY;
+	// Derived values needing a recompute, see _dirty
+	enum : unsigned int {
+		VIEW = 1u << 0,
+		PROJECTION = 1u << 1,
+		VIEW_PROJECTION = 1u << 2,
+		INVERSE_VIEW_PROJECTION = 1u << 3,
+		FRUSTUM = 1u << 4,
+	};
+
+	/// @brief Flags derived values as stale and bumps the version
+	/// @param changed VIEW and/or PROJECTION
+	void invalidate(unsigned int changed);
+
+	/// @brief Recomputes the front, right and up vectors from the Euler angles
+	void updateVectors();
+
+	// Camera attributes
+	glm::vec3 _position;
+	glm::vec3 _front;
+	glm::vec3 _up;
+	glm::vec3 _right;
+	glm::vec3 _worldUp;
+
+	// Last mouse positions; raw motion keeps growing, so they stay in double precision
+	double _lastX;
+	double _lastY;
 
 	// Euler angles
 	float _yaw;
@@ -58,8 +116,24 @@ private:
 	float _mouseSensitivity;
 	float _zoom;
 
+	// Projection
+	float _aspect = 1.0f;
+	float _nearPlane = 0.1f;
+	float _farPlane = 100.0f;
+
 	// Mouse state on start up
 	bool _firstMouse = true;
 
+	// Change counter, starts above zero so a cache holding 0 is always stale
+	uint64_t _version = 1;
+
+	// Derived values, valid unless flagged in _dirty
+	mutable unsigned int _dirty = VIEW | PROJECTION | VIEW_PROJECTION | INVERSE_VIEW_PROJECTION | FRUSTUM;
+	mutable glm::mat4 _view;
+	mutable glm::mat4 _projection;
+	mutable glm::mat4 _viewProjection;
+	mutable glm::mat4 _inverseViewProjection;
+	mutable Frustum _frustum;
+
 };
-#endif
\ No newline at end of file
+#endif
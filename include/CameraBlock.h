@@ -0,0 +1,62 @@
+#ifndef __CAMERA_BLOCK_H__
+#define __CAMERA_BLOCK_H__
+
+#include <glad/gl.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <glm/glm.hpp>
+
+// Uniform buffer binding point every program's CameraBlock is attached to
+#define CAMERA_BLOCK_BINDING 0
+
+// @brief CPU mirror of the std140 CameraBlock declared in shaders/camera.glsl
+struct CameraBlock {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 viewProjection;
+    glm::vec4 position;                                     // xyz = world space position, w unused
+};
+static_assert(offsetof(CameraBlock, view) == 0, "CameraBlock must match std140 layout");
+static_assert(offsetof(CameraBlock, projection) == 64, "CameraBlock must match std140 layout");
+static_assert(offsetof(CameraBlock, viewProjection) == 128, "CameraBlock must match std140 layout");
+static_assert(offsetof(CameraBlock, position) == 192, "CameraBlock must match std140 layout");
+static_assert(sizeof(CameraBlock) == 208, "CameraBlock must match std140 layout");
+
+// @brief Fill the CameraBlock shared by every program for the current frame.
+//        Written once per camera change, so camera updates cost the same regardless of the program count.
+// @param block      Block to fill, e.g. the copy CameraBuffer::update uploads
+// @param view       View matrix
+// @param projection Projection matrix
+// @param position   World space position of the camera
+void setCameraBlock(CameraBlock& block, const glm::mat4& view, const glm::mat4& projection, const glm::vec3& position);
+
+// @brief Uniform buffer holding only the CameraBlock, bound to CAMERA_BLOCK_BINDING and rewritten
+//        only when the camera version changes. The block is small enough that drivers copy the
+//        update into the command stream rather than wait for frames still reading the old one.
+class CameraBuffer {
+public:
+
+    // buffer object ID
+    unsigned int ID;
+
+    // @brief Create the buffer and bind it to CAMERA_BLOCK_BINDING
+    CameraBuffer();
+
+    // @brief Upload the block unless the buffer already holds this version of the camera
+    // @param version    Camera::version() the matrices come from
+    // @param view       View matrix
+    // @param projection Projection matrix
+    // @param position   World space position of the camera
+    // @return Whether the block was uploaded
+    bool update(uint64_t version, const glm::mat4& view, const glm::mat4& projection, const glm::vec3& position);
+
+    // @brief Delete the buffer
+    void deleteBuffer();
+
+private:
+    uint64_t _version = 0;                                  // camera version in the buffer, 0 before the first upload
+};
+
+#endif // __CAMERA_BLOCK_H__
@@ -0,0 +1,172 @@
+#ifndef __COMMAND_BUFFER_H__
+#define __COMMAND_BUFFER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "IndirectDraw.h"
+#include "Mesh.h"
+#include "Shader.h"
+#include "Uniform.h"
+
+// @brief Passes in the order they are drawn; the pass is the most significant part of a sort key
+enum class RenderPass : uint64_t {
+    Opaque = 0,                                             // front to back, grouped by state
+    Transparent = 1                                         // back to front, state second
+};
+
+// @brief Commands a CommandBuffer can hold. Each is stored as a CommandHeader followed by the
+//        plain struct of the same name.
+enum class CommandType : uint16_t {
+    UseProgram,
+    SetUniformMat4,
+    DrawMesh,
+    DrawIndirect
+};
+
+struct CommandHeader {
+    CommandType type;
+    uint16_t size;                                          // bytes of the struct that follows
+};
+
+struct UseProgramCommand {
+    Shader* shader;
+};
+
+struct SetUniformMat4Command {
+    Shader* shader;                                         // program the location belongs to, already in use
+    int location;
+    glm::mat4 value;
+};
+
+struct DrawMeshCommand {
+    Shader* shader;
+    Mesh* mesh;
+    uint32_t instanceCount;                                 // 0 for a single non-instanced draw
+};
+
+struct DrawIndirectCommand {
+    Shader* shader;
+    Mesh* mesh;
+    IndirectDrawList* list;                                 // must have been culled this frame
+};
+
+// @brief Program, material and vertex array fields of a sort key
+struct SortKeyState {
+    uint32_t program;
+    uint32_t material;
+    uint32_t vertexArray;
+};
+
+// @brief Draws recorded without touching GL, so any thread can fill one; RenderQueue sorts the
+//        buffers of every thread together and replays them on the GL thread.
+//
+//        Commands are grouped into packets, each with a 64-bit sort key. Packets are sorted as a
+//        whole, so a packet must set all the state its draw needs.
+//
+//        Opaque key:      pass:2 | program:10 | material:14 | vao:14 | depth:24
+//        Transparent key: pass:2 | inverted depth:24 | program:10 | material:14 | vao:14
+//
+//        The program and vertex array fields hold the GL names and the material field a hash of the
+//        mesh's textures, so keys need no shared table. Past the field widths they alias, which
+//        only costs some grouping.
+class CommandBuffer {
+public:
+
+    // @brief Create an empty buffer
+    // @param nearPlane Closest depth that is told apart, normally the near plane
+    // @param farPlane  Farthest depth that is told apart, normally the far plane
+    CommandBuffer(float nearPlane = 0.1f, float farPlane = 100.0f);
+
+    // @brief Record a single draw of a mesh with its own model matrix, written to the "model" uniform
+    // @param pass   Pass to draw in
+    // @param shader Program to draw with, must be ready
+    // @param mesh   Mesh to draw
+    // @param model  Model matrix of the draw
+    // @param depth  View space distance used for ordering
+    void submit(RenderPass pass, Shader& shader, Mesh& mesh, const glm::mat4& model, float depth);
+
+    // @brief Record an instanced draw of a mesh whose transforms live in an instance buffer
+    // @param pass          Pass to draw in
+    // @param shader        Program to draw with
+    // @param mesh          Mesh to draw
+    // @param instanceCount Number of instances
+    // @param depth         View space distance used for ordering
+    void submitInstanced(RenderPass pass, Shader& shader, Mesh& mesh, size_t instanceCount, float depth);
+
+    // @brief Record a GPU culled multi-draw; the list must be culled before the buffer is replayed
+    // @param pass   Pass to draw in
+    // @param shader Program to draw with
+    // @param mesh   Mesh the list was built for
+    // @param list   Objects to draw
+    // @param depth  View space distance used for ordering
+    void submitIndirect(RenderPass pass, Shader& shader, Mesh& mesh, IndirectDrawList& list, float depth);
+
+    // @brief Start a packet; the commands recorded until the next one are sorted by its key
+    // @param key Sort key, see sortKey()
+    void begin(uint64_t key);
+
+    // @brief Record binding a program
+    void useProgram(Shader& shader);
+
+    // @brief Record a matrix uniform write to the program last bound in the packet
+    // @param shader   Program the location belongs to
+    // @param location Location from Shader::getUniformLocation, -1 records nothing
+    // @param value    Value to write
+    void setUniform(Shader& shader, int location, const glm::mat4& value);
+
+    // @brief Record drawing a mesh with its material
+    // @param instanceCount Number of instances, 0 for a single non-instanced draw
+    void drawMesh(Shader& shader, Mesh& mesh, size_t instanceCount);
+
+    // @brief Record drawing the survivors of an indirect draw list
+    void drawIndirect(Shader& shader, Mesh& mesh, IndirectDrawList& list);
+
+    // @brief Build the sort key of a draw
+    // @param pass   Pass to draw in
+    // @param shader Program to draw with
+    // @param mesh   Mesh to draw
+    // @param depth  View space distance used for ordering
+    uint64_t sortKey(RenderPass pass, const Shader& shader, const Mesh& mesh, float depth) const;
+
+    // @brief Forget every packet, keeping the memory
+    void clear();
+
+    // @brief Number of packets
+    size_t size() const { return _keys.size(); }
+
+    // @brief Sort key of a packet
+    uint64_t key(size_t packet) const { return _keys[packet]; }
+
+    // @brief Issue the GL calls of a packet; GL thread only
+    void replay(size_t packet) const;
+
+    // @brief Split the state fields out of a sort key
+    static SortKeyState keyState(uint64_t key);
+
+private:
+
+    float _nearPlane;
+    float _farPlane;
+
+    std::vector<uint64_t> _keys;                            // sort key of each packet
+    std::vector<uint32_t> _packets;                         // offset of each packet in _data
+    std::vector<unsigned char> _data;                       // headers and command structs
+
+    // resolved against whichever program the buffer records for; each buffer has its own handle,
+    // so threads never share the cached location
+    Uniform<glm::mat4> _modelUniform{"model"};
+
+    // @brief Append a header and a command struct to the current packet
+    template <typename T>
+    void record(CommandType type, const T& command);
+
+    // @brief Quantize a view space distance to 24 bits on a logarithmic scale
+    uint32_t quantizeDepth(float depth) const;
+};
+
+#endif // __COMMAND_BUFFER_H__
@@ -0,0 +1,40 @@
+#ifndef __COMPUTE_SHADER_H__
+#define __COMPUTE_SHADER_H__
+
+#include <glad/gl.h>
+
+#include "ShaderPreprocessor.h"
+
+// @brief Compute program built from a single source file. Requires OpenGL 4.3; only construct
+//        one when glExtensions.multiDrawIndirect is set.
+class ComputeShader {
+public:
+
+    // program ID, 0 if the build failed
+    unsigned int ID;
+
+    // @brief Compile and link a compute program, blocking until the driver is done
+    // @param compute_path Path to the compute shader source file
+    // @param defines      Defines injected after #version
+    ComputeShader(const char* compute_path, const ShaderDefines& defines = ShaderDefines());
+
+    // @brief Whether the program compiled and linked
+    bool isValid() const { return ID != 0; }
+
+    // @brief Bind the program
+    void use();
+
+    // @brief Location of a uniform, -1 if it is not active
+    // @param name Name of the uniform
+    int getUniformLocation(const char* name) const { return glGetUniformLocation(ID, name); }
+
+    // @brief Dispatch enough work groups to cover a number of invocations
+    // @param invocations Number of invocations along x
+    // @param groupSize   local_size_x declared by the shader
+    void dispatch(unsigned int invocations, unsigned int groupSize);
+
+    // @brief Delete the program
+    void deleteShader();
+};
+
+#endif // __COMPUTE_SHADER_H__
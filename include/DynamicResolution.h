@@ -0,0 +1,89 @@
+#ifndef __DYNAMIC_RESOLUTION_H__
+#define __DYNAMIC_RESOLUTION_H__
+
+#include <glad/gl.h>
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Framebuffer.h"
+#include "Shader.h"
+#include "Uniform.h"
+
+// @brief Renders the scene into an offscreen target whose resolution follows the GPU frame time,
+//        then upscales it to the output with a bilinear filter and an optional sharpening pass.
+//        The scale drops as soon as frames run over the budget and climbs back slowly once they
+//        are comfortably under it; the target is allocated at the largest scale, so changing
+//        the scale only changes the viewport and never reallocates.
+class DynamicResolution {
+public:
+
+    // @brief Create the offscreen target and the upscale program
+    // @param vertexPath         Path to the upscale vertex shader
+    // @param fragmentPath       Path to the upscale fragment shader
+    // @param width              Output width in pixels
+    // @param height             Output height in pixels
+    // @param budgetMilliseconds GPU time per frame to stay within; 0 keeps the largest scale
+    // @param minScale           Smallest scale of each axis
+    // @param maxScale           Largest scale of each axis
+    DynamicResolution(const char* vertexPath, const char* fragmentPath, int width, int height,
+                      double budgetMilliseconds, float minScale = 0.5f, float maxScale = 1.0f);
+
+    // @brief Follow a change of the output size, e.g. after the window was resized
+    // @param width  Output width in pixels, ignored if 0 as for a minimized window
+    // @param height Output height in pixels, ignored if 0
+    void resize(int width, int height);
+
+    // @brief Feed GPU times of whole frames, oldest first, and adjust the scale
+    // @param milliseconds Samples collected since the last call, e.g. from GPUFrameTimer
+    void update(const std::vector<double>& milliseconds);
+
+    // @brief Bind the offscreen target with the viewport set to the current render size
+    void beginScene();
+
+    // @brief Upscale the rendered scene into a framebuffer covering the output size
+    // @param framebuffer Framebuffer to draw into, 0 for the window
+    void present(unsigned int framebuffer);
+
+    // @brief Sharpening applied while upscaling, 0 for plain bilinear
+    void setSharpness(float sharpness) { _sharpness = sharpness; }
+
+    float scale() const { return _scale; }
+    int renderWidth() const;
+    int renderHeight() const;
+
+    // @brief Aspect ratio of the output, for the projection
+    float aspect() const { return (float)_outputWidth / (float)_outputHeight; }
+
+    // @brief Smoothed GPU frame time the controller last acted on, in milliseconds
+    double gpuMilliseconds() const { return _smoothed; }
+
+    // @brief Delete the target, the program and the vertex array
+    void deleteResources();
+
+private:
+    Framebuffer _scene;
+    Shader _shader;
+    unsigned int _vao = 0;
+
+    Uniform<int> _sceneTextureUniform{"sceneTexture"};
+    Uniform<glm::vec2> _uvScaleUniform{"uvScale"};
+    Uniform<float> _sharpnessUniform{"sharpness"};
+
+    int _outputWidth;
+    int _outputHeight;
+    double _budget;
+    float _minScale;
+    float _maxScale;
+    float _scale;
+    float _sharpness = 0.25f;
+
+    double _smoothed = 0.0;
+    unsigned int _samples = 0;                              // samples averaged at the current scale
+    unsigned int _settle = 0;                               // samples still to skip after a change
+
+    void setScale(float scale);
+};
+
+#endif // __DYNAMIC_RESOLUTION_H__
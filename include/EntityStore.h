@@ -0,0 +1,185 @@
+#ifndef __ENTITY_STORE_H__
+#define __ENTITY_STORE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "CommandBuffer.h"
+#include "InstanceBuffer.h"
+#include "LightBlock.h"
+#include "TransformBatch.h"
+
+class Mesh;
+class Shader;
+
+// @brief Handle to an entity: slot index in the low 24 bits, generation of the slot in the high 8,
+//        so a handle kept after destroy() does not alias the next entity created in its slot
+typedef uint32_t Entity;
+
+// Handle that never refers to a live entity
+#define NULL_ENTITY 0xFFFFFFFFu
+
+// @brief Component kinds, combined into masks
+enum Component : uint32_t {
+    TransformComponent = 1u << 0,                           // translation, rotation, scale and the matrices built from them
+    BoundsComponent = 1u << 1,                              // bounding sphere, culled against the camera
+    RenderableComponent = 1u << 2,                          // mesh and program the entity is drawn with
+    InstancedComponent = 1u << 3,                           // drawn as part of an instance batch instead of on its own
+    PointLightComponent = 1u << 4,                          // point light at the entity's translation
+    OrbitComponent = 1u << 5,                               // circles a centre point over time
+};
+typedef uint32_t ComponentMask;
+
+// @brief What an entity is drawn with
+struct Renderable {
+    Mesh* mesh = nullptr;
+    Shader* shader = nullptr;
+    RenderPass pass = RenderPass::Opaque;
+};
+
+// @brief Instance batch an entity is drawn in
+struct Instanced {
+    uint32_t batch = 0;
+};
+
+// @brief Circular motion in the xz plane around a centre
+struct Orbit {
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 1.0f;
+    float speed = 1.0f;                                     // radians per second
+};
+
+// @brief Every entity with one exact component mask. Each component lives in its own contiguous
+//        column indexed by row, so systems walk the columns they need linearly; columns of
+//        components outside the mask stay empty.
+struct Archetype {
+    ComponentMask mask = 0;
+    std::vector<Entity> entities;
+
+    // Transform
+    TransformBatch transforms;                              // translation, rotation and scale as structure-of-arrays
+    std::vector<InstanceData> instances;                    // model and normal matrices, written by updateTransforms
+    TransformBatch previousTransforms;                      // transforms before the last simulation step, see
+                                                            // saveTransforms; emptied when rows are added or removed
+    TransformBatch drawTransforms;                          // blend of the last two steps the instances are built from
+
+    // Bounds
+    std::vector<float> localX, localY, localZ, localRadius; // sphere in model space
+    std::vector<float> worldX, worldY, worldZ, worldRadius; // sphere in world space, written by updateBounds
+    std::vector<uint32_t> visibleRows;                      // rows that passed the last cullBounds, ascending
+    size_t visibleCount = 0;                                // entries of visibleRows in use
+    bool culled = false;                                    // cleared when rows are added or removed
+    uint64_t boundsVersion = 0;                             // bumped by updateBounds when a world sphere changes
+    uint64_t culledCameraVersion = 0;                       // camera and bounds the visible rows were culled with
+    uint64_t culledBoundsVersion = 0;
+
+    std::vector<Renderable> renderables;
+    std::vector<Instanced> instanced;
+    std::vector<PointLight> pointLights;
+    std::vector<Orbit> orbits;
+
+    size_t size() const { return entities.size(); }
+
+    // @brief Whether the archetype holds every component of a mask
+    bool has(ComponentMask components) const { return (mask & components) == components; }
+
+    // @brief Number of rows that passed the last cullBounds; every row if the archetype has no
+    //        bounds or its rows changed since
+    size_t visibleSize() const { return cullCurrent() ? visibleCount : size(); }
+
+    // @brief Row of the i-th visible entity, for i below visibleSize()
+    size_t visibleRow(size_t i) const { return cullCurrent() ? visibleRows[i] : i; }
+
+    // @brief Whether visibleRows holds the result of culling the current rows
+    bool cullCurrent() const { return culled && has(BoundsComponent); }
+};
+
+// @brief Entity component store grouping entities by archetype. Creating an entity with its full
+//        component mask places it directly in its archetype; adding or removing components later
+//        moves its row to another archetype. Rows are kept packed by moving the last row into
+//        any hole, so row order is not stable.
+class EntityStore {
+public:
+
+    // Largest number of entities alive at once
+    static const uint32_t MAX_ENTITIES = 1u << 24;
+
+    EntityStore();
+
+    // @brief Create an entity with default values for every component in a mask
+    // @param components Components of the entity
+    // @return The entity, or NULL_ENTITY once MAX_ENTITIES are alive
+    Entity create(ComponentMask components);
+
+    // @brief Destroy an entity and its components; the handle stops being alive
+    void destroy(Entity entity);
+
+    // @brief Whether a handle refers to an entity that has not been destroyed
+    bool isAlive(Entity entity) const;
+
+    // @brief Components of a live entity
+    ComponentMask components(Entity entity) const;
+
+    // @brief Add components with default values, moving the entity to its new archetype
+    void addComponents(Entity entity, ComponentMask components);
+
+    // @brief Remove components, moving the entity to its new archetype
+    void removeComponents(Entity entity, ComponentMask components);
+
+    // Per-entity access for setup and gameplay code; systems should iterate archetypes instead.
+    // Each call expects a live entity holding the component.
+    void setTransform(Entity entity, const glm::vec3& translation,
+                      const glm::quat& rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+                      const glm::vec3& scale = glm::vec3(1.0f));
+    void setTranslation(Entity entity, const glm::vec3& translation);
+    glm::vec3 translation(Entity entity) const;
+    void setBounds(Entity entity, const glm::vec3& center, float radius);
+    Renderable& renderable(Entity entity);
+    Instanced& instanced(Entity entity);
+    PointLight& pointLight(Entity entity);
+    Orbit& orbit(Entity entity);
+
+    // @brief Call a function with every non-empty archetype holding all of the given components
+    // @param components Components the archetypes must have
+    // @param function   Called as function(Archetype&)
+    template <typename Function>
+    void forEach(ComponentMask components, Function&& function) {
+        for (std::unique_ptr<Archetype>& archetype : _archetypes) {
+            if (archetype->has(components) && archetype->size() > 0)
+                function(*archetype);
+        }
+    }
+
+    // @brief Number of live entities
+    size_t size() const { return _alive; }
+
+private:
+
+    // @brief Where the entity in a slot lives
+    struct Slot {
+        uint32_t archetype = 0;
+        uint32_t row = 0;
+        uint32_t generation = 0;
+        bool alive = false;
+    };
+
+    std::vector<std::unique_ptr<Archetype>> _archetypes;
+    std::vector<Slot> _slots;
+    std::vector<uint32_t> _freeSlots;
+    size_t _alive = 0;
+
+    const Slot& slot(Entity entity) const { return _slots[entity & (MAX_ENTITIES - 1)]; }
+    Slot& slot(Entity entity) { return _slots[entity & (MAX_ENTITIES - 1)]; }
+
+    uint32_t findArchetype(ComponentMask components);
+    void moveEntity(Entity entity, ComponentMask components);
+    void removeRow(uint32_t archetype, uint32_t row);
+};
+
+#endif // __ENTITY_STORE_H__
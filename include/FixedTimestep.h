@@ -0,0 +1,56 @@
+#ifndef __FIXED_TIMESTEP_H__
+#define __FIXED_TIMESTEP_H__
+
+#include <stdint.h>
+
+// @brief Clock of a simulation advancing in steps of a fixed length, independent of the frame rate.
+//        Real time is accumulated each frame and consumed one step at a time; what is left over is
+//        how far the presented frame lies between the last two simulated states.
+//        Time is kept in integer units of 1 / (ticksPerSecond * stepsPerSecond) seconds, a whole
+//        number of them per clock tick and per step, so frames of equal ticks always run the same
+//        number of steps and no rounding error builds up.
+//
+//        Per frame: accumulate(), then simulate while step() is true, then draw with alpha().
+class FixedTimestep {
+public:
+
+    // @brief Create a clock at time zero
+    // @param ticksPerSecond Rate of the clock frames are measured with, e.g. 1000000000 for nanoseconds
+    // @param stepsPerSecond Steps per simulated second
+    // @param maxSteps       Most steps run for one frame; real time beyond that is dropped, so a slow
+    //                       frame cannot make the next one slower still
+    FixedTimestep(uint64_t ticksPerSecond, unsigned int stepsPerSecond, unsigned int maxSteps);
+
+    // @brief Add the real time a frame took
+    // @param frameTicks Clock ticks since the previous frame
+    void accumulate(uint64_t frameTicks);
+
+    // @brief Consume one step of the accumulated time
+    // @return Whether a step is due; the simulation then advances to time()
+    bool step();
+
+    // @brief Fraction of a step accumulated past the last simulated state, in [0, 1)
+    float alpha() const { return (float)((double)_accumulator / (double)_ticksPerSecond); }
+
+    // @brief Simulated seconds per step
+    double stepSeconds() const { return 1.0 / (double)_stepsPerSecond; }
+
+    // @brief Simulated time after the last step
+    double time() const { return (double)_steps / (double)_stepsPerSecond; }
+
+    // @brief Number of steps taken since the start
+    uint64_t steps() const { return _steps; }
+
+    // @brief Number of frames whose real time was partly dropped
+    uint64_t droppedFrames() const { return _droppedFrames; }
+
+private:
+    uint64_t _ticksPerSecond;                               // units in one step
+    uint64_t _stepsPerSecond;                               // units in one clock tick
+    uint64_t _maxAccumulated;                               // maxSteps whole steps
+    uint64_t _accumulator = 0;
+    uint64_t _steps = 0;
+    uint64_t _droppedFrames = 0;
+};
+
+#endif // __FIXED_TIMESTEP_H__
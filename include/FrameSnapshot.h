@@ -0,0 +1,87 @@
+#ifndef __FRAME_SNAPSHOT_H__
+#define __FRAME_SNAPSHOT_H__
+
+#include <stdint.h>
+
+#include <atomic>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "CommandBuffer.h"
+#include "InstanceBuffer.h"
+#include "LightBlock.h"
+
+// @brief Everything the render thread needs to draw one frame, written by the simulation thread
+//        and read-only once published. Nothing in it points into the entity store.
+struct FrameSnapshot {
+    glm::mat4 view = glm::mat4(1.0f);
+    glm::mat4 projection = glm::mat4(1.0f);
+    glm::vec3 cameraPosition = glm::vec3(0.0f);
+    uint64_t cameraVersion = 0;                             // Camera::version() of the matrices above
+    LightBlock lights;
+
+    std::vector<CommandBuffer> commands;                    // visible renderables outside instance batches,
+                                                            // one buffer per job thread
+    float nearestContainer = 0.0f;                          // depth the container batch is sorted by
+    std::vector<InstanceData> containerInstances;           // visible containers, when they are not culled on the GPU
+
+    int outputWidth = 0;                                    // size of the window or offscreen target
+    int outputHeight = 0;
+    int frameIndex = 0;
+    bool capture = false;                                   // start a profiler capture with this frame
+    bool quit = false;                                      // last snapshot; the render thread exits on it
+};
+
+// @brief Lock-free triple buffer handing snapshots from one producer thread to one consumer thread.
+//        The producer fills back() while the consumer reads the front slot; publish() swaps the back
+//        slot with the one in the middle and acquire() swaps that with the front.
+//
+//        publish() waits until the previously published snapshot has been acquired, so the producer
+//        runs at most one frame ahead of the consumer and no snapshot is dropped.
+template <typename T>
+class SnapshotBuffer {
+public:
+
+    // @brief Slot the producer writes the next snapshot into; producer only
+    T& back() { return _slots[_back]; }
+
+    // @brief Hand the back slot to the consumer, first waiting until it took the previous one;
+    //        producer only
+    void publish() {
+        unsigned int middle = _middle.load(std::memory_order_acquire);
+        while (middle & DIRTY) {
+            _middle.wait(middle, std::memory_order_acquire);
+            middle = _middle.load(std::memory_order_acquire);
+        }
+        middle = _middle.exchange(_back | DIRTY, std::memory_order_acq_rel);
+        _middle.notify_one();
+        _back = middle & ~DIRTY;
+    }
+
+    // @brief Wait for a published snapshot and take it; consumer only. The snapshot stays valid
+    //        until the next call.
+    const T& acquire() {
+        unsigned int middle = _middle.load(std::memory_order_acquire);
+        while (!(middle & DIRTY)) {
+            _middle.wait(middle, std::memory_order_acquire);
+            middle = _middle.load(std::memory_order_acquire);
+        }
+        middle = _middle.exchange(_front, std::memory_order_acq_rel);
+        _middle.notify_one();
+        _front = middle & ~DIRTY;
+        return _slots[_front];
+    }
+
+private:
+
+    // Set in _middle while it holds a snapshot the consumer has not acquired
+    static const unsigned int DIRTY = 4;
+
+    T _slots[3];
+    unsigned int _back = 0;                                 // producer's slot
+    unsigned int _front = 1;                                // consumer's slot
+    alignas(64) std::atomic<unsigned int> _middle{2};       // slot index, with DIRTY once published
+};
+
+#endif // __FRAME_SNAPSHOT_H__
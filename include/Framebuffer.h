@@ -0,0 +1,45 @@
+#ifndef __FRAMEBUFFER_H__
+#define __FRAMEBUFFER_H__
+
+#include <glad/gl.h>
+
+// @brief Offscreen render target with an RGBA8 colour texture and a 24-bit depth, 8-bit stencil renderbuffer
+class Framebuffer {
+public:
+
+    // framebuffer object ID
+    unsigned int ID;
+
+    // colour attachment, sampleable once rendering into it is finished
+    unsigned int ColorTexture;
+
+    // @brief Create the framebuffer and its attachments
+    // @param width  Width in pixels
+    // @param height Height in pixels
+    Framebuffer(int width, int height);
+
+    // @brief Reallocate the attachments at a new size; the contents are undefined afterwards
+    // @param width  Width in pixels
+    // @param height Height in pixels
+    void resize(int width, int height);
+
+    // @brief Bind the framebuffer for drawing and set the viewport to cover it
+    void bind();
+
+    // @brief Whether every attachment was accepted by the driver
+    bool isComplete() const { return _complete; }
+
+    int width() const { return _width; }
+    int height() const { return _height; }
+
+    // @brief Delete the framebuffer and its attachments
+    void deleteFramebuffer();
+
+private:
+    unsigned int _depthStencil;
+    int _width = 0;
+    int _height = 0;
+    bool _complete = false;
+};
+
+#endif // __FRAMEBUFFER_H__
@@ -0,0 +1,59 @@
+#ifndef __FRUSTUM_CULLING_H__
+#define __FRUSTUM_CULLING_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <glm/glm.hpp>
+
+// @brief The six planes of a view frustum, normalized so the plane equation gives a distance.
+//        A point p is inside when dot(plane.xyz, p) + plane.w >= 0 for every plane.
+struct Frustum {
+    glm::vec4 planes[6];                                    // left, right, bottom, top, near, far
+};
+
+// @brief Extract the frustum planes from the rows of a view projection matrix (Gribb and Hartmann)
+// @param viewProjection Projection times view matrix of the camera
+Frustum extractFrustum(const glm::mat4& viewProjection);
+
+// @brief Test bounding spheres stored as structure-of-arrays against a frustum, eight at a time
+//        with AVX2 or four with SSE when available, and list the ones touching it
+// @param frustum    Planes to test against
+// @param x          Sphere centres, x coordinates
+// @param y          Sphere centres, y coordinates
+// @param z          Sphere centres, z coordinates
+// @param radius     Sphere radii
+// @param count      Number of spheres, any value
+// @param visible    Receives the indices of the visible spheres in ascending order; must hold count
+// @param firstIndex Added to every index written, e.g. the offset of a range within a larger array
+// @return Number of indices written
+size_t cullSpheres(const Frustum& frustum, const float* x, const float* y, const float* z, const float* radius,
+                   size_t count, uint32_t* visible, uint32_t firstIndex = 0);
+
+// @brief Test axis aligned boxes stored as structure-of-arrays against a frustum, with the corner
+//        furthest along each plane normal; same vector widths and output as cullSpheres
+// @param frustum    Planes to test against
+// @param minX       Smallest corner of each box, x coordinates
+// @param minY       Smallest corner of each box, y coordinates
+// @param minZ       Smallest corner of each box, z coordinates
+// @param maxX       Largest corner of each box, x coordinates
+// @param maxY       Largest corner of each box, y coordinates
+// @param maxZ       Largest corner of each box, z coordinates
+// @param count      Number of boxes, any value
+// @param visible    Receives the indices of the visible boxes in ascending order; must hold count
+// @param firstIndex Added to every index written
+// @return Number of indices written
+size_t cullBoxes(const Frustum& frustum, const float* minX, const float* minY, const float* minZ,
+                 const float* maxX, const float* maxY, const float* maxZ, size_t count, uint32_t* visible,
+                 uint32_t firstIndex = 0);
+
+// @brief Reference implementation of cullSpheres without SIMD
+size_t cullSpheresScalar(const Frustum& frustum, const float* x, const float* y, const float* z,
+                         const float* radius, size_t count, uint32_t* visible, uint32_t firstIndex = 0);
+
+// @brief Reference implementation of cullBoxes without SIMD
+size_t cullBoxesScalar(const Frustum& frustum, const float* minX, const float* minY, const float* minZ,
+                       const float* maxX, const float* maxY, const float* maxZ, size_t count, uint32_t* visible,
+                       uint32_t firstIndex = 0);
+
+#endif // __FRUSTUM_CULLING_H__
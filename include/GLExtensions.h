@@ -0,0 +1,131 @@
+#ifndef __GL_EXTENSIONS_H__
+#define __GL_EXTENSIONS_H__
+
+#include <glad/gl.h>
+
+// gl.c only loads the OpenGL 3.3 core profile. Entry points from later
+// versions and extensions are declared here and loaded by loadGLExtensions,
+// using the same glad_ prefix and macro aliasing as the generated loader.
+
+// ARB_get_program_binary / OpenGL 4.1
+#ifndef GL_VERSION_4_1
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#define GL_PROGRAM_BINARY_FORMATS 0x87FF
+
+typedef void (GLAD_API_PTR *PFNGLGETPROGRAMBINARYPROC)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
+typedef void (GLAD_API_PTR *PFNGLPROGRAMBINARYPROC)(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
+typedef void (GLAD_API_PTR *PFNGLPROGRAMPARAMETERIPROC)(GLuint program, GLenum pname, GLint value);
+
+extern PFNGLGETPROGRAMBINARYPROC glad_glGetProgramBinary;
+#define glGetProgramBinary glad_glGetProgramBinary
+extern PFNGLPROGRAMBINARYPROC glad_glProgramBinary;
+#define glProgramBinary glad_glProgramBinary
+extern PFNGLPROGRAMPARAMETERIPROC glad_glProgramParameteri;
+#define glProgramParameteri glad_glProgramParameteri
+#endif
+
+// KHR_parallel_shader_compile / ARB_parallel_shader_compile
+#ifndef GL_KHR_parallel_shader_compile
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+
+typedef void (GLAD_API_PTR *PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+
+extern PFNGLMAXSHADERCOMPILERTHREADSKHRPROC glad_glMaxShaderCompilerThreadsKHR;
+#define glMaxShaderCompilerThreadsKHR glad_glMaxShaderCompilerThreadsKHR
+#endif
+
+// ARB_draw_indirect / OpenGL 4.0
+#ifndef GL_VERSION_4_0
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+
+// ARB_shader_image_load_store / OpenGL 4.2
+#ifndef GL_VERSION_4_2
+#define GL_COMMAND_BARRIER_BIT 0x00000040
+
+typedef void (GLAD_API_PTR *PFNGLMEMORYBARRIERPROC)(GLbitfield barriers);
+
+extern PFNGLMEMORYBARRIERPROC glad_glMemoryBarrier;
+#define glMemoryBarrier glad_glMemoryBarrier
+#endif
+
+// ARB_compute_shader, ARB_shader_storage_buffer_object, ARB_multi_draw_indirect / OpenGL 4.3
+#ifndef GL_VERSION_4_3
+#define GL_COMPUTE_SHADER 0x91B9
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#define GL_SHADER_STORAGE_BARRIER_BIT 0x00002000
+
+typedef void (GLAD_API_PTR *PFNGLDISPATCHCOMPUTEPROC)(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
+typedef void (GLAD_API_PTR *PFNGLMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void *indirect, GLsizei drawcount, GLsizei stride);
+
+extern PFNGLDISPATCHCOMPUTEPROC glad_glDispatchCompute;
+#define glDispatchCompute glad_glDispatchCompute
+extern PFNGLMULTIDRAWELEMENTSINDIRECTPROC glad_glMultiDrawElementsIndirect;
+#define glMultiDrawElementsIndirect glad_glMultiDrawElementsIndirect
+#endif
+
+// KHR_debug / OpenGL 4.3
+#ifndef GL_KHR_debug
+#define GL_DEBUG_SOURCE_APPLICATION 0x824A
+
+typedef void (GLAD_API_PTR *PFNGLPUSHDEBUGGROUPPROC)(GLenum source, GLuint id, GLsizei length, const GLchar *message);
+typedef void (GLAD_API_PTR *PFNGLPOPDEBUGGROUPPROC)(void);
+
+extern PFNGLPUSHDEBUGGROUPPROC glad_glPushDebugGroup;
+#define glPushDebugGroup glad_glPushDebugGroup
+extern PFNGLPOPDEBUGGROUPPROC glad_glPopDebugGroup;
+#define glPopDebugGroup glad_glPopDebugGroup
+#endif
+
+// ARB_buffer_storage / OpenGL 4.4
+#ifndef GL_VERSION_4_4
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#define GL_CLIENT_STORAGE_BIT 0x0200
+
+typedef void (GLAD_API_PTR *PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
+
+extern PFNGLBUFFERSTORAGEPROC glad_glBufferStorage;
+#define glBufferStorage glad_glBufferStorage
+#endif
+
+// ARB_indirect_parameters / OpenGL 4.6
+#ifndef GL_ARB_indirect_parameters
+#define GL_PARAMETER_BUFFER_ARB 0x80EE
+
+typedef void (GLAD_API_PTR *PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTARBPROC)(GLenum mode, GLenum type, const void *indirect, GLintptr drawcount, GLsizei maxdrawcount, GLsizei stride);
+
+extern PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTARBPROC glad_glMultiDrawElementsIndirectCountARB;
+#define glMultiDrawElementsIndirectCountARB glad_glMultiDrawElementsIndirectCountARB
+#endif
+
+// @brief Features available on the current context beyond OpenGL 3.3 core
+struct GLExtensions {
+    int major = 0;
+    int minor = 0;
+
+    bool programBinary = false;                             // ARB_get_program_binary with at least one binary format
+    bool parallelShaderCompile = false;                     // GL_COMPLETION_STATUS_KHR can be polled
+    bool multiDrawIndirect = false;                         // compute shaders, storage buffers and glMultiDrawElementsIndirect
+    bool indirectParameters = false;                        // the draw count of a multi-draw can come from a buffer
+    bool debugGroups = false;                               // KHR_debug groups name command ranges in graphics debuggers
+    bool bufferStorage = false;                             // immutable buffers that stay mapped while the GPU reads them
+};
+
+// Features of the context loadGLExtensions was last called on
+extern GLExtensions glExtensions;
+
+// @brief Load entry points and detect features beyond OpenGL 3.3 core.
+//        Must be called with a current context, after gladLoadGL.
+// @param load Function used to look up GL entry points, e.g. glfwGetProcAddress
+void loadGLExtensions(GLADloadfunc load);
+
+// @brief Check whether the current context advertises an extension
+// @param name Name of the extension, e.g. "GL_KHR_debug"
+bool hasGLExtension(const char* name);
+
+#endif // __GL_EXTENSIONS_H__
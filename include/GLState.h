@@ -0,0 +1,94 @@
+#ifndef __GL_STATE_H__
+#define __GL_STATE_H__
+
+#include <glad/gl.h>
+
+#include <stdint.h>
+
+// @brief Shadow of the GL binding state that filters out calls which would not change anything.
+//        Every bind of a tracked object must go through this cache, otherwise it goes stale;
+//        call invalidate() after code that binds objects directly.
+class GLStateCache {
+public:
+
+    // Texture units whose bindings are tracked; higher units are passed straight through
+    static const unsigned int MAX_TEXTURE_UNITS = 32;
+
+    // @brief Calls issued to and elided from the driver
+    struct Stats {
+        uint32_t issued = 0;
+        uint32_t elided = 0;
+        uint32_t uniformsIssued = 0;
+        uint32_t uniformsElided = 0;
+    };
+
+    GLStateCache() { invalidate(); }
+
+    // @brief Bind a program
+    // @param program ID of the program
+    void useProgram(unsigned int program);
+
+    // @brief Bind a vertex array object
+    // @param vao ID of the vertex array object
+    void bindVertexArray(unsigned int vao);
+
+    // @brief Select the active texture unit
+    // @param unit Index of the unit, starting at 0 for GL_TEXTURE0
+    void activeTexture(unsigned int unit);
+
+    // @brief Bind a texture to a unit, switching the active unit only when needed
+    // @param unit    Index of the unit, starting at 0 for GL_TEXTURE0
+    // @param target  Texture target, e.g. GL_TEXTURE_2D
+    // @param texture ID of the texture
+    void bindTexture(unsigned int unit, GLenum target, unsigned int texture);
+
+    // @brief Bind a sampler object to a unit
+    // @param unit    Index of the unit, starting at 0 for GL_TEXTURE0
+    // @param sampler ID of the sampler
+    void bindSampler(unsigned int unit, unsigned int sampler);
+
+    // @brief Forget deleted objects so a recycled ID is not mistaken for the bound one
+    void forgetProgram(unsigned int program);
+    void forgetVertexArray(unsigned int vao);
+    void forgetTexture(unsigned int texture);
+
+    // @brief Forget every tracked binding; the next call of each kind is always issued
+    void invalidate();
+
+    // @brief Record a uniform upload made or skipped by Shader
+    void countUniform(bool elided) {
+        if (elided)
+            _current.uniformsElided++;
+        else
+            _current.uniformsIssued++;
+    }
+
+    // @brief Start counting a new frame
+    void beginFrame() {
+        _lastFrame = _current;
+        _current = Stats();
+    }
+
+    // @brief Counters of the last complete frame
+    const Stats& lastFrame() const { return _lastFrame; }
+
+private:
+
+    // Number of texture targets tracked per unit
+    static const unsigned int TRACKED_TARGETS = 4;
+    static const unsigned int UNKNOWN = 0xFFFFFFFF;
+
+    unsigned int _program;
+    unsigned int _vao;
+    unsigned int _activeUnit;
+    unsigned int _textures[MAX_TEXTURE_UNITS][TRACKED_TARGETS];
+    unsigned int _samplers[MAX_TEXTURE_UNITS];
+
+    Stats _current;
+    Stats _lastFrame;
+};
+
+// State cache of the context owned by the render loop
+extern GLStateCache glState;
+
+#endif // __GL_STATE_H__
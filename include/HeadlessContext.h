@@ -0,0 +1,35 @@
+#ifndef __HEADLESS_CONTEXT_H__
+#define __HEADLESS_CONTEXT_H__
+
+#include <glad/gl.h>
+
+// @brief OpenGL core context without a window or any surface, for rendering into framebuffer
+//        objects on machines without a display. Uses EGL_MESA_platform_surfaceless, which Mesa
+//        provides even without a GPU (llvmpipe). Only available when built with HAS_EGL.
+class HeadlessContext {
+public:
+
+    // @brief Create the context and make it current, trying OpenGL 4.3 core before 3.3 core
+    // @return Whether a context is current
+    bool create();
+
+    // @brief Make the context current on the calling thread, e.g. a render thread. It must have
+    //        been released by the thread it was current on.
+    // @return Whether the context is current
+    bool makeCurrent();
+
+    // @brief Detach the context from the calling thread so another thread can make it current
+    void release();
+
+    // @brief Look up a GL entry point; pass to gladLoadGL and loadGLExtensions
+    static GLADapiproc getProcAddress(const char* name);
+
+    // @brief Release the context and the display
+    void destroy();
+
+private:
+    void* _display = nullptr;                               // EGLDisplay
+    void* _context = nullptr;                               // EGLContext
+};
+
+#endif // __HEADLESS_CONTEXT_H__
@@ -0,0 +1,68 @@
+#ifndef __INDIRECT_DRAW_H__
+#define __INDIRECT_DRAW_H__
+
+#include <glad/gl.h>
+
+#include <stddef.h>
+
+#include "ComputeShader.h"
+#include "InstanceBuffer.h"
+#include "Mesh.h"
+#include "Shader.h"
+
+// @brief Layout of one command read by glMultiDrawElementsIndirect; see shaders/cull.comp
+struct DrawElementsIndirectCommand {
+    GLuint count;                                           // indices per draw
+    GLuint instanceCount;                                   // 0 skips the draw
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;                                    // selects the object's InstanceData
+};
+
+// @brief Objects sharing one mesh, culled against the view frustum by a compute shader and drawn
+//        with a single glMultiDrawElementsIndirect. Bounds and draw commands live in GPU buffers,
+//        one command per object drawing one instance at baseInstance.
+//        Requires glExtensions.multiDrawIndirect; use Mesh::DrawInstanced otherwise.
+class IndirectDrawList {
+public:
+
+    // work group size declared by shaders/cull.comp
+    static const unsigned int CULL_GROUP_SIZE = 64;
+
+    // @brief Build the culling program and the empty buffers
+    // @param cull_path Path to the culling compute shader
+    IndirectDrawList(const char* cull_path);
+
+    // @brief Upload bounds and draw commands for objects whose transforms are in the mesh's instance buffer
+    // @param mesh      Mesh drawn by every object
+    // @param instances Transforms of the objects, in instance buffer order
+    // @param count     Number of objects
+    void build(const Mesh& mesh, const InstanceData* instances, size_t count);
+
+    // @brief Run frustum culling against the current camera block; call before draw()
+    void cull();
+
+    // @brief Draw the objects that survived the last cull
+    // @param shader Program to draw with, must already be in use
+    // @param mesh   Mesh passed to build()
+    void draw(Shader& shader, Mesh& mesh);
+
+    // @brief Number of objects in the list
+    size_t size() const { return _objectCount; }
+
+    // @brief Delete the buffers and the culling program
+    void deleteBuffers();
+
+private:
+    ComputeShader _cull;
+    int _objectCountLocation;
+    bool _compact;
+
+    unsigned int _boundsBuffer;
+    unsigned int _commandBuffer;
+    unsigned int _visibleBuffer;
+    unsigned int _countBuffer;
+    size_t _objectCount = 0;
+};
+
+#endif // __INDIRECT_DRAW_H__
@@ -0,0 +1,115 @@
+#ifndef __INPUT_QUEUE_H__
+#define __INPUT_QUEUE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+// @brief One input event as delivered by a window system callback
+struct InputEvent {
+    enum class Type : uint8_t {
+        CursorPosition,                                     // x, y: cursor position, or raw motion when enabled
+        Scroll,                                             // x, y: scroll offsets
+    };
+
+    Type type;
+    double time;                                            // seconds, on the clock of the producer
+    double x;
+    double y;
+};
+
+// @brief Lock-free ring handing input events from one producer thread to one consumer thread.
+//        Neither side waits. With GLFW both ends currently run on the main thread, since the
+//        callbacks fire inside glfwPollEvents; the ring keeps them apart so the simulation can
+//        take events once per step however many arrived, and polling could move to a thread of
+//        its own without changing the consumer.
+//        A full ring loses nothing: events that do not fit are held back by the producer, one
+//        per type, the latest cursor position replacing the previous and scroll offsets adding
+//        up, and published once the consumer has made room.
+class InputQueue {
+public:
+
+    // Events the ring holds; a power of two, and far more than a frame of an 8000 Hz mouse
+    static const size_t CAPACITY = 1024;
+
+    // @brief Append an event, after any held back ones; producer only
+    // @return Whether it went into the ring, otherwise it is held back until flush() finds room
+    bool push(const InputEvent& event) {
+        flush();
+        size_t type = (size_t)event.type;
+        if (!_held[type] && publish(event))
+            return true;
+
+        if (!_held[type]) {
+            _heldEvents[type] = event;
+            _held[type] = true;
+        } else {
+            InputEvent& held = _heldEvents[type];
+            held.time = event.time;
+            if (event.type == InputEvent::Type::Scroll) {
+                held.x += event.x;
+                held.y += event.y;
+            } else {
+                held.x = event.x;
+                held.y = event.y;
+            }
+        }
+        _coalesced.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // @brief Publish the held back events the ring has room for; producer only, e.g. after
+    //        delivering a batch of window system events
+    // @return Whether none are left held back
+    bool flush() {
+        for (size_t type = 0; type < TYPE_COUNT; type++)
+            if (_held[type] && publish(_heldEvents[type]))
+                _held[type] = false;
+        return !_held[0] && !_held[1];
+    }
+
+    // @brief Take the oldest event if it happened no later than a given time; consumer only
+    // @param event Receives the event
+    // @param until Latest event time to take, on the clock of the producer
+    // @return Whether there was one
+    bool pop(InputEvent& event, double until) {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire))
+            return false;
+        const InputEvent& oldest = _events[head & (CAPACITY - 1)];
+        if (oldest.time > until)
+            return false;
+        event = oldest;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // @brief Number of events that found the ring full and were merged into a held back one
+    uint64_t coalesced() const { return _coalesced.load(std::memory_order_relaxed); }
+
+private:
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "capacity must be a power of two");
+
+    // One held back event per InputEvent::Type
+    static const size_t TYPE_COUNT = 2;
+
+    // @brief Append an event to the ring if it has room; producer only
+    bool publish(const InputEvent& event) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head.load(std::memory_order_acquire) == CAPACITY)
+            return false;
+        _events[tail & (CAPACITY - 1)] = event;
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    InputEvent _events[CAPACITY];
+    alignas(64) std::atomic<size_t> _head{0};               // next event to pop, written by the consumer
+    alignas(64) std::atomic<size_t> _tail{0};               // next slot to fill, written by the producer
+    std::atomic<uint64_t> _coalesced{0};
+    InputEvent _heldEvents[TYPE_COUNT];                     // producer only, not yet in the ring
+    bool _held[TYPE_COUNT] = {false, false};
+};
+
+#endif // __INPUT_QUEUE_H__
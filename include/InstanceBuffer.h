@@ -0,0 +1,56 @@
+#ifndef __INSTANCE_BUFFER_H__
+#define __INSTANCE_BUFFER_H__
+
+#include <glad/gl.h>
+
+#include <stddef.h>
+
+#include <glm/glm.hpp>
+
+// First vertex attribute location used by per-instance data; see shaders/shader.vs
+#define INSTANCE_ATTRIBUTE_LOCATION 3
+
+// @brief Per-instance transform read by shaders/shader.vs as vertex attributes
+struct InstanceData {
+    glm::mat4 model;                                        // locations 3-6
+    glm::mat3 normalMatrix;                                 // locations 7-9
+};
+
+// @brief Vertex buffer holding one InstanceData per instance, stepped once per instance
+class InstanceBuffer {
+public:
+
+    // buffer object ID
+    unsigned int ID;
+
+    // @brief Create an empty instance buffer
+    InstanceBuffer();
+
+    // @brief Point the instance attributes of a vertex array object at this buffer
+    // @param vao ID of the vertex array object
+    void attach(unsigned int vao) { attach(vao, ID, 0); }
+
+    // @brief Point the instance attributes of a vertex array object at instances held elsewhere,
+    //        e.g. an UploadRing allocation
+    // @param vao    ID of the vertex array object
+    // @param buffer Buffer object holding consecutive InstanceData
+    // @param offset Byte offset of the first instance in the buffer
+    static void attach(unsigned int vao, unsigned int buffer, GLintptr offset);
+
+    // @brief Replace the contents of the buffer
+    // @param instances Instance data to upload
+    // @param count     Number of instances
+    // @param usage     Buffer usage hint, GL_DYNAMIC_DRAW for data rewritten every frame
+    void upload(const InstanceData* instances, size_t count, GLenum usage = GL_STATIC_DRAW);
+
+    // @brief Number of instances held by the buffer
+    size_t size() const { return _count; }
+
+    // @brief Delete the buffer
+    void deleteBuffer();
+
+private:
+
+    size_t _count = 0;
+};
+#endif // __INSTANCE_BUFFER_H__
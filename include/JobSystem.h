@@ -0,0 +1,212 @@
+#ifndef __JOB_SYSTEM_H__
+#define __JOB_SYSTEM_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Bytes of closure a job stores inline
+#define JOB_DATA_SIZE 48
+
+class JobCounter;
+
+// @brief A function and its captured state, allocated from a per-thread ring so scheduling never
+//        touches the heap
+struct Job {
+    void (*function)(Job& job) = nullptr;
+    JobCounter* counter = nullptr;
+    std::atomic<uint32_t> run{0};                           // run of the system that queued it, 0 once started
+    alignas(16) unsigned char data[JOB_DATA_SIZE];
+};
+
+// @brief Number of scheduled jobs that have not finished. Waiting on a counter runs other jobs
+//        meanwhile, so waiting inside a job cannot deadlock the pool.
+class JobCounter {
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    // @brief Whether every job counted here has finished
+    bool done() const { return _pending.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+    std::atomic<int> _pending{0};
+};
+
+// @brief Chase-Lev work-stealing deque of fixed capacity (Le et al. 2013). The owning thread pushes
+//        and pops at the bottom, other threads steal the oldest job from the top.
+class JobDeque {
+public:
+
+    // Jobs held at once; must be a power of two
+    static const int64_t CAPACITY = 4096;
+
+    // @brief Add a job; owner only
+    // @return False if the deque is full
+    bool push(Job* job);
+
+    // @brief Take the newest job; owner only
+    Job* pop();
+
+    // @brief Take the oldest job; any thread
+    Job* steal();
+
+private:
+    alignas(64) std::atomic<int64_t> _top{0};
+    alignas(64) std::atomic<int64_t> _bottom{0};
+    alignas(64) std::atomic<Job*> _jobs[CAPACITY];
+};
+
+// @brief Fixed pool of worker threads running jobs from per-thread work-stealing deques.
+//        The thread calling start() takes part as thread 0 whenever it waits, and is the only
+//        thread running jobs scheduled with scheduleMainThread(), e.g. anything using the GL
+//        context. Until start() is called every job runs inline on the scheduling thread.
+class JobSystem {
+public:
+
+    // Slots in each thread's job ring; a thread with this many jobs unfinished runs other jobs
+    // until its oldest slot is free again
+    static const unsigned int POOL_SIZE = 4096;
+
+    JobSystem() = default;
+    ~JobSystem() { stop(); }
+
+    // @brief Start the workers; the calling thread becomes the main thread
+    // @param workerCount Threads besides the main thread, e.g. hardware_concurrency() - 1
+    void start(unsigned int workerCount);
+
+    // @brief Finish the running jobs and join the workers; jobs still queued are dropped
+    void stop();
+
+    // @brief Threads running jobs, including the main thread
+    unsigned int threadCount() const { return (unsigned int)_threads.size() + 1; }
+
+    // @brief Whether the calling thread is the one that called start()
+    bool isMainThread() const;
+
+    // @brief Index of the calling thread in the pool, below threadCount(): 0 for the main thread,
+    //        and for any thread before start(). Threads outside the pool get -1.
+    int threadIndex() const;
+
+    // @brief Run a function on any thread
+    // @param counter    Counter incremented now and decremented once the function returned
+    // @param function   Callable taking no arguments, at most JOB_DATA_SIZE bytes
+    // @param dependency Counter that must be done before the function runs, or null
+    template <typename Function>
+    void schedule(JobCounter& counter, Function&& function, JobCounter* dependency = nullptr) {
+        if (dependency) {
+            // waiting helps with other jobs, so the dependency is still worked on
+            submit(makeJob(counter, [this, dependency, function]() mutable {
+                wait(*dependency);
+                function();
+            }), false);
+            return;
+        }
+        submit(makeJob(counter, std::forward<Function>(function)), false);
+    }
+
+    // @brief Run a function on the main thread, the next time it waits or calls runMainThreadJobs()
+    // @param counter  Counter incremented now and decremented once the function returned
+    // @param function Callable taking no arguments, at most JOB_DATA_SIZE bytes
+    template <typename Function>
+    void scheduleMainThread(JobCounter& counter, Function&& function) {
+        submit(makeJob(counter, std::forward<Function>(function)), true);
+    }
+
+    // @brief Run jobs until a counter is done
+    void wait(JobCounter& counter);
+
+    // @brief Run every job queued for the main thread; main thread only
+    void runMainThreadJobs();
+
+    // @brief Call a function over [0, count) split into ranges, and wait for all of them
+    // @param count    Number of items
+    // @param grain    Items per job; smaller ranges are not split
+    // @param function Called as function(begin, end) from any thread
+    template <typename Function>
+    void parallelFor(size_t count, size_t grain, Function&& function) {
+        if (count == 0)
+            return;
+        if (_threads.empty() || count <= grain) {
+            function((size_t)0, count);
+            return;
+        }
+        JobCounter counter;
+        for (size_t begin = 0; begin < count; begin += grain) {
+            size_t end = begin + grain < count ? begin + grain : count;
+            schedule(counter, [&function, begin, end]() { function(begin, end); });
+        }
+        wait(counter);
+    }
+
+private:
+
+    // @brief Deque and victim selection of one thread; index 0 is the main thread
+    struct Worker {
+        JobDeque deque;
+        uint32_t random = 0;
+    };
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::vector<std::thread> _threads;
+    std::thread::id _mainThread;
+    std::atomic<bool> _stop{false};
+
+    // bumped by stop(), so the ring slots of jobs dropped there count as free
+    std::atomic<uint32_t> _run{1};
+
+    // idle workers sleep on the epoch until a job is pushed
+    std::atomic<uint32_t> _epoch{0};
+    std::atomic<int> _sleeping{0};
+
+    // jobs for the main thread, and jobs scheduled from threads outside the pool
+    std::mutex _queueMutex;
+    std::vector<Job*> _mainQueue;
+    std::vector<Job*> _injected;
+    std::atomic<int> _mainQueued{0};
+    std::atomic<int> _injectedQueued{0};
+
+    template <typename Function>
+    Job* makeJob(JobCounter& counter, Function&& function) {
+        typedef typename std::decay<Function>::type Closure;
+        static_assert(sizeof(Closure) <= JOB_DATA_SIZE, "job closure too large, capture by reference");
+        static_assert(alignof(Closure) <= 16, "job closure over-aligned");
+
+        Job* job = allocateJob();
+        new (job->data) Closure(std::forward<Function>(function));
+        job->function = [](Job& job) {
+            // run a copy, so the slot is free again while the job runs and schedules more
+            Closure* stored = std::launder(reinterpret_cast<Closure*>(job.data));
+            Closure closure(std::move(*stored));
+            stored->~Closure();
+            job.run.store(0, std::memory_order_release);
+            closure();
+        };
+        job->counter = &counter;
+        counter._pending.fetch_add(1, std::memory_order_relaxed);
+        return job;
+    }
+
+    Job* allocateJob();
+    void submit(Job* job, bool mainThread);
+    Job* findJob(int worker);
+    void execute(Job* job);
+    void runOneJob();
+    void wake();
+    void workerLoop(int worker);
+};
+
+// Job system shared by the application
+extern JobSystem jobs;
+
+#endif // __JOB_SYSTEM_H__
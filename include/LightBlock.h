@@ -0,0 +1,63 @@
+#ifndef __LIGHT_BLOCK_H__
+#define __LIGHT_BLOCK_H__
+
+#include <stddef.h>
+
+#include <glm/glm.hpp>
+
+// Uniform buffer binding point every program's LightBlock is attached to
+#define LIGHT_BLOCK_BINDING 1
+
+// Size of the point light array in the block; permutations shade the first NUM_POINT_LIGHTS
+#define MAX_POINT_LIGHTS 4
+
+// CPU mirrors of the std140 structs in shaders/lights.glsl. Each vec3 shares its
+// 16-byte slot with the float after it.
+struct PointLight {
+    glm::vec3 position;
+    float constant;
+    glm::vec3 ambient;
+    float linear;
+    glm::vec3 diffuse;
+    float quadratic;
+    glm::vec3 specular;
+    float padding;
+};
+static_assert(sizeof(PointLight) == 64, "PointLight must match std140 layout");
+
+struct DirectionalLight {
+    glm::vec3 direction;
+    float padding0;
+    glm::vec3 ambient;
+    float padding1;
+    glm::vec3 diffuse;
+    float padding2;
+    glm::vec3 specular;
+    float padding3;
+};
+static_assert(sizeof(DirectionalLight) == 64, "DirectionalLight must match std140 layout");
+
+struct SpotLight {
+    glm::vec3 position;
+    float cutOff;
+    glm::vec3 direction;
+    float constant;
+    glm::vec3 ambient;
+    float linear;
+    glm::vec3 diffuse;
+    float quadratic;
+    glm::vec3 specular;
+    float padding;
+};
+static_assert(sizeof(SpotLight) == 80, "SpotLight must match std140 layout");
+
+// @brief CPU mirror of the std140 LightBlock declared in shaders/lights.glsl
+struct LightBlock {
+    PointLight pointLights[MAX_POINT_LIGHTS];
+    DirectionalLight dirLight;
+    SpotLight spotLight;
+};
+static_assert(offsetof(LightBlock, dirLight) == 64 * MAX_POINT_LIGHTS, "LightBlock must match std140 layout");
+static_assert(offsetof(LightBlock, spotLight) == 64 * MAX_POINT_LIGHTS + 64, "LightBlock must match std140 layout");
+
+#endif // __LIGHT_BLOCK_H__
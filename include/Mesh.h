@@ -1,33 +1,99 @@
-#include <vector>
+#ifndef __MESH_H__
+#define __MESH_H__
+
+#include <glad/gl.h>
+
+#include <stddef.h>
+
 #include <string>
+#include <vector>
 
+#include <glm/glm.hpp>
+
+#include "MeshOptimizer.h"
 #include "Shader.h"
-#include "Texture.h"
-#ifndef __MESH_H__
-#define __MESH_H__
+#include "Uniform.h"
+#include "VertexFormat.h"
+
+// @brief Texture used by a mesh; type names its sampler in the Material struct, e.g. "diffuse"
+struct Texture {
+	unsigned int id;
+	std::string type;
+};
+
+// @brief Vertex cache and fetch efficiency of a mesh before and after optimization
+struct MeshStats {
+	VertexCacheStats cacheBefore;
+	VertexCacheStats cacheAfter;
+	VertexFetchStats fetchBefore;
+	VertexFetchStats fetchAfter;
+};
 
 class Mesh {
 public:
 
 	// mesh properties
-	vector<Vertex> vertices;
-	vector<unsigned int> indices;
-	vector<Texture> textures;
+	std::vector<Vertex> vertices;
+	std::vector<unsigned int> indices;
+	std::vector<Texture> textures;
 
-	/// @brief Constructs a new Mesh object
+	/// @brief Constructs a new Mesh object, reordering its triangles and vertices for the GPU caches
 	/// @param vertices The vertices of the mesh
 	/// @param indices The indices for indexed drawing
-	/// @param textures The textures associated with the mesh
-	Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures);
+	/// @param textures The textures associated with the mesh, bound to units in this order
+	Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures);
 	
 	/// @brief Draws the mesh using the provided shader
-	/// @param shader The shader to use for drawing the mesh
+	/// @param shader The shader to use for drawing the mesh, must already be in use
 	void Draw(Shader& shader);
+
+	/// @brief Draws several instances of the mesh in one call
+	/// @param shader The shader to use for drawing the mesh, must already be in use
+	/// @param instanceCount The number of instances to draw
+	void DrawInstanced(Shader& shader, size_t instanceCount);
+
+	/// @brief Draws the mesh once per command in the buffer bound to GL_DRAW_INDIRECT_BUFFER (OpenGL 4.3)
+	/// @param shader The shader to use for drawing the mesh, must already be in use
+	/// @param maxDrawCount The number of commands in the buffer
+	/// @param countFromBuffer Read the number of commands from offset 0 of GL_PARAMETER_BUFFER_ARB instead
+	void DrawIndirect(Shader& shader, size_t maxDrawCount, bool countFromBuffer);
+
+	/// @brief Returns the vertex array object of the mesh, e.g. to attach instance attributes
+	unsigned int getVAO() const { return _VAO; }
+
+	/// @brief Returns the layout the vertices were encoded in on the GPU
+	VertexFormat getVertexFormat() const { return _format; }
+
+	/// @brief Returns the cache statistics gathered while optimizing the mesh
+	const MeshStats& getStats() const { return _stats; }
+
+	/// @brief Prints the cache statistics gathered while optimizing the mesh
+	/// @param name The name to print the statistics under
+	void printStats(const char* name) const;
+
+	/// @brief Deletes the GPU buffers of the mesh
+	void deleteMesh();
+
 private:
 	unsigned int _VAO, _VBO, _EBO;
+	GLenum _indexType;
+	MeshStats _stats;
 
-	/// @brief Create the mesh to run the shader
+	// vertex layout on the GPU and the bounds quantized positions are relative to
+	VertexFormat _format;
+	glm::vec3 _positionOffset;
+	glm::vec3 _positionScale;
+	Uniform<glm::vec3> _positionOffsetUniform{"positionOffset"};
+	Uniform<glm::vec3> _positionScaleUniform{"positionScale"};
+
+	// sampler uniform of each texture, e.g. "material.diffuse"
+	std::vector<std::string> _samplerNames;
+
+	/// @brief Optimize the mesh and create the buffers to run the shader
 	void setupMesh();
+
+	/// @brief Bind the textures, point the samplers at them and set the position decoding
+	void bindMaterial(Shader& shader);
 };
 
 #endif // __MESH_H__
@@ -0,0 +1,69 @@
+#ifndef __MESH_OPTIMIZER_H__
+#define __MESH_OPTIMIZER_H__
+
+#include <stddef.h>
+
+// Size of the post-transform vertex cache assumed by the optimizer and the analysis
+#define VERTEX_CACHE_SIZE 16
+
+// @brief Post-transform vertex cache efficiency of an index buffer
+struct VertexCacheStats {
+    float acmr = 0.0f;                                      // average cache miss ratio, vertices shaded per triangle (0.5 - 3)
+    float atvr = 0.0f;                                      // average transform to vertex ratio, vertices shaded per unique vertex (>= 1)
+};
+
+// @brief Pre-transform vertex fetch efficiency of a vertex and index buffer
+struct VertexFetchStats {
+    size_t bytesFetched = 0;                                // bytes read from memory in whole 64-byte cache lines
+    float overfetch = 0.0f;                                 // bytes fetched relative to the vertex buffer size (>= 1)
+};
+
+// @brief Simulate a FIFO post-transform cache over an index buffer
+// @param indices     Triangle list indices
+// @param indexCount  Number of indices
+// @param vertexCount Number of vertices referenced by the indices
+// @param cacheSize   Number of entries in the simulated cache
+VertexCacheStats analyzeVertexCache(const unsigned int* indices, size_t indexCount, size_t vertexCount,
+                                    unsigned int cacheSize = VERTEX_CACHE_SIZE);
+
+// @brief Simulate the memory traffic of fetching vertices in index order
+// @param indices     Triangle list indices
+// @param indexCount  Number of indices
+// @param vertexCount Number of vertices
+// @param vertexSize  Size of one vertex in bytes
+VertexFetchStats analyzeVertexFetch(const unsigned int* indices, size_t indexCount, size_t vertexCount,
+                                    size_t vertexSize);
+
+// @brief Reorder triangles for the post-transform vertex cache (Tipsify, Sander et al. 2007).
+//        Runs in linear time and works for any cache size at or above the one given.
+// @param indices     Triangle list indices, reordered in place
+// @param indexCount  Number of indices
+// @param vertexCount Number of vertices referenced by the indices
+// @param cacheSize   Size of the cache to optimize for
+void optimizeVertexCache(unsigned int* indices, size_t indexCount, size_t vertexCount,
+                         unsigned int cacheSize = VERTEX_CACHE_SIZE);
+
+// @brief Reorder clusters of a cache-optimized index buffer so triangles likely to occlude
+//        others are drawn first. Clusters start wherever the cache order jumps, and the
+//        reordering is discarded if it raises the ACMR by more than the threshold.
+// @param indices        Triangle list indices, already cache optimized, reordered in place
+// @param indexCount     Number of indices
+// @param positions      Vertex positions, three floats at the start of each vertex
+// @param vertexCount    Number of vertices
+// @param vertexStride   Distance between two vertices in bytes
+// @param threshold      Largest allowed ACMR ratio after reordering, e.g. 1.05
+void optimizeOverdraw(unsigned int* indices, size_t indexCount, const float* positions, size_t vertexCount,
+                      size_t vertexStride, float threshold = 1.05f);
+
+// @brief Reorder vertices in the order they are first referenced so fetches walk memory linearly.
+//        Vertices not referenced by any index are dropped.
+// @param vertices    Vertex data, reordered in place
+// @param vertexCount Number of vertices
+// @param vertexSize  Size of one vertex in bytes
+// @param indices     Triangle list indices, remapped in place
+// @param indexCount  Number of indices
+// @return Number of vertices left
+size_t optimizeVertexFetch(void* vertices, size_t vertexCount, size_t vertexSize, unsigned int* indices,
+                           size_t indexCount);
+
+#endif // __MESH_OPTIMIZER_H__
@@ -0,0 +1,197 @@
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+// Frame profiler, compiled in with ENABLE_PROFILER (cmake -DENABLE_PROFILER=ON). Without it the
+// macros below expand to nothing and none of the profiler is built.
+//
+//   PROFILE_FRAME()              at the top of the frame loop
+//   PROFILE_SCOPE("name")        times the rest of the enclosing block on the CPU, on any thread
+//   PROFILE_GPU_SCOPE("name")    times the GL commands of the enclosing block and names them as a
+//                                KHR_debug group; GL thread only
+//   PROFILE_THREAD("name")       names the calling thread in the trace
+//   PROFILE_CAPTURE(n, "path")   records the next n frames and writes them as a Chrome trace
+//   PROFILE_SHUTDOWN()           writes a capture still in progress and frees the GL queries
+//
+// Names must be string literals or otherwise outlive the capture.
+
+#ifdef ENABLE_PROFILER
+
+#include <glad/gl.h>
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#define PROFILER_X86 1
+#include <immintrin.h>
+#endif
+
+// @brief Events of one thread. Only the owning thread appends, and only it resets the buffer when
+//        it first records in a new capture; the count is published with release ordering so the
+//        exporter can read completed events without a lock.
+struct ProfileThreadBuffer {
+
+    // @brief One completed scope, in Profiler::ticks() for CPU scopes and in nanoseconds since the
+    //        profiler started for GPU scopes
+    struct Event {
+        const char* name;
+        int64_t start;
+        int64_t end;
+    };
+
+    // Events kept per thread and capture; further events are dropped
+    static const size_t CAPACITY = 1 << 16;
+
+    std::vector<Event> events;
+    std::atomic<size_t> count{0};
+    std::atomic<unsigned int> generation{0};                // capture the events belong to
+    std::string name;
+    unsigned int id = 0;
+};
+
+class Profiler {
+public:
+
+    // Frames between issuing GPU timestamps and reading them back
+    static const unsigned int GPU_LATENCY = 4;
+
+    // GPU scopes per frame; further scopes still push debug groups but are not timed
+    static const unsigned int MAX_GPU_SCOPES = 64;
+
+    Profiler();
+
+    // @brief Mark a frame boundary: advances the capture and reads back GPU timestamps that are ready
+    void beginFrame();
+
+    // @brief Record the next frames and write them as a Chrome trace once their GPU times are in
+    // @param frames Number of frames to record
+    // @param path   Trace file, viewable in chrome://tracing or ui.perfetto.dev
+    void capture(unsigned int frames, const std::string& path);
+
+    // @brief Whether scopes are being recorded
+    bool capturing() const { return _recording.load(std::memory_order_relaxed); }
+
+    // @brief Nanoseconds since the profiler was created
+    int64_t now() const;
+
+    // @brief Timestamp of CPU scopes, converted to nanoseconds when the trace is written: the
+    //        invariant time stamp counter on x86, which reads in half the time of the steady clock,
+    //        and the steady clock elsewhere
+    static int64_t ticks() {
+#ifdef PROFILER_X86
+        return (int64_t)__rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    // @brief Name the calling thread in the trace
+    void setThreadName(const char* name);
+
+    // @brief Store a completed CPU scope of the calling thread; ignored outside a capture or if start is negative
+    void recordCPU(const char* name, int64_t start, int64_t end);
+
+    // @brief Start a GPU scope; returns its slot, or -1 if it is not timed
+    int beginGPU(const char* name);
+
+    // @brief End a GPU scope started by beginGPU
+    void endGPU(int slot);
+
+    // @brief Write a capture still in progress, waiting for its GPU times, and delete the timestamp
+    //        queries; call while the context is current
+    void shutdown();
+
+private:
+
+    // @brief GPU scopes issued in one frame, read back GPU_LATENCY frames later
+    struct GPUFrame {
+        const char* names[MAX_GPU_SCOPES];
+        unsigned int queries[MAX_GPU_SCOPES * 2];
+        unsigned int count = 0;
+        bool pending = false;
+    };
+
+    ProfileThreadBuffer& threadBuffer();
+    void collectGPU(GPUFrame& frame, bool wait);
+    void writeTrace();
+
+    std::mutex _threadsMutex;
+    std::vector<ProfileThreadBuffer*> _threads;
+
+    std::atomic<bool> _recording{false};
+    std::atomic<unsigned int> _generation{0};               // bumped by every capture, see ProfileThreadBuffer
+    int64_t _startTicks = 0;                                // ticks() and now() when the capture started,
+    int64_t _startNanoseconds = 0;                          // to convert CPU events
+    unsigned int _framesLeft = 0;                           // frames still to record
+    unsigned int _drainFrames = 0;                          // frames to wait for GPU results before writing
+    std::string _path;
+
+    GPUFrame _gpuFrames[GPU_LATENCY];
+    unsigned int _gpuFrame = 0;
+    bool _queriesCreated = false;
+    int64_t _gpuOffset = 0;                                 // CPU time minus GPU time, in nanoseconds
+    std::vector<ProfileThreadBuffer::Event> _gpuEvents;
+};
+
+// Profiler used by the PROFILE_ macros
+extern Profiler profiler;
+
+// @brief Records the CPU time from construction to destruction. Outside a capture this costs one
+//        relaxed load on each end.
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name) : _name(name), _start(profiler.capturing() ? Profiler::ticks() : -1) {}
+    ~ProfileScope() {
+        if (_start >= 0)
+            profiler.recordCPU(_name, _start, Profiler::ticks());
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* _name;
+    int64_t _start;
+};
+
+// @brief Times the GL commands issued between construction and destruction
+class GPUProfileScope {
+public:
+    explicit GPUProfileScope(const char* name) : _slot(profiler.beginGPU(name)) {}
+    ~GPUProfileScope() { profiler.endGPU(_slot); }
+
+    GPUProfileScope(const GPUProfileScope&) = delete;
+    GPUProfileScope& operator=(const GPUProfileScope&) = delete;
+
+private:
+    int _slot;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+#define PROFILE_FRAME() profiler.beginFrame()
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(_profileScope, __LINE__)(name)
+#define PROFILE_GPU_SCOPE(name) GPUProfileScope PROFILE_CONCAT(_gpuProfileScope, __LINE__)(name)
+#define PROFILE_THREAD(name) profiler.setThreadName(name)
+#define PROFILE_CAPTURE(frames, path) profiler.capture(frames, path)
+#define PROFILE_SHUTDOWN() profiler.shutdown()
+
+#else
+
+#define PROFILE_FRAME() ((void)0)
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_GPU_SCOPE(name) ((void)0)
+#define PROFILE_THREAD(name) ((void)0)
+#define PROFILE_CAPTURE(frames, path) ((void)0)
+#define PROFILE_SHUTDOWN() ((void)0)
+
+#endif // ENABLE_PROFILER
+
+#endif // __PROFILER_H__
@@ -0,0 +1,66 @@
+#ifndef __PROGRAM_CACHE_H__
+#define __PROGRAM_CACHE_H__
+
+#include <stdint.h>
+
+#include <string>
+#include <string_view>
+
+// @brief On-disk cache of linked program binaries.
+//        Entries are keyed by the shader sources, the defines they were built
+//        with and the driver's vendor, renderer and version strings, so a
+//        driver update invalidates every entry automatically.
+class ProgramCache {
+public:
+
+    // @brief Construct a cache storing binaries in a directory.
+    //        Requires a current context; the driver strings are read here.
+    // @param directory Directory holding the cached binaries, created if missing
+    ProgramCache(const std::string& directory);
+
+    // @brief Compute the cache key of a program
+    // @param vertexSource   Vertex shader source code
+    // @param fragmentSource Fragment shader source code
+    // @param defines        Defines the sources were built with
+    uint64_t makeKey(std::string_view vertexSource, std::string_view fragmentSource,
+                     std::string_view defines) const;
+
+    // @brief Create a program from a cached binary
+    // @param key Cache key from makeKey
+    // @return ID of the linked program, or 0 on a miss, a truncated or corrupt entry, or if the
+    //         driver rejected the binary; unusable entries are deleted
+    unsigned int load(uint64_t key);
+
+    // @brief Save a freshly linked program to the cache.
+    //        The program must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set.
+    // @param key            Cache key from makeKey
+    // @param program        ID of the linked program
+    // @param buildSeconds   Time taken to compile and link the program from source
+    void store(uint64_t key, unsigned int program, double buildSeconds);
+
+    // @brief Whether the context supports program binaries at all
+    bool enabled() const { return _enabled; }
+
+    // @brief Print hits, misses and the build time saved by the cache
+    void printStats() const;
+
+    unsigned int hits() const { return _hits; }
+    unsigned int misses() const { return _misses; }
+    unsigned int rejected() const { return _rejected; }
+    double secondsSaved() const { return _secondsSaved; }
+
+private:
+
+    std::string _directory;
+    uint64_t _driverHash = 0;
+    bool _enabled = false;
+
+    unsigned int _hits = 0;
+    unsigned int _misses = 0;
+    unsigned int _rejected = 0;                             // corrupt binaries and those the driver refused, counted as misses too
+    double _secondsSaved = 0.0;
+
+    /// @brief Path of the file holding the binary for a key
+    std::string pathFor(uint64_t key) const;
+};
+#endif // __PROGRAM_CACHE_H__
@@ -0,0 +1,113 @@
+#ifndef __RENDER_QUEUE_H__
+#define __RENDER_QUEUE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "CommandBuffer.h"
+#include "IndirectDraw.h"
+#include "Mesh.h"
+#include "Shader.h"
+
+// @brief Sort 64-bit keys with a least significant digit radix sort, carrying a value along.
+//        Digits are 11 bits wide, six passes in all; a digit equal in every key skips its pass.
+// @param keys         Keys to sort, sorted in place
+// @param values       Value of each key, permuted with the keys
+// @param count        Number of keys
+// @param keyScratch   Scratch space for count keys
+// @param valueScratch Scratch space for count values
+void radixSortKeys(uint64_t* keys, uint32_t* values, size_t count, uint64_t* keyScratch, uint32_t* valueScratch);
+
+// @brief Draws collected over a frame from any number of command buffers, sorted by their 64-bit
+//        keys and replayed on the GL thread. Worker threads record into buffers of their own and
+//        append them; the queue's own buffer takes draws submitted on the GL thread. See
+//        CommandBuffer for the key layout.
+class RenderQueue {
+public:
+
+    // @brief State changes made by the last flush and the time spent sorting
+    struct Stats {
+        uint32_t commands = 0;
+        uint32_t programChanges = 0;
+        uint32_t materialChanges = 0;
+        uint32_t vertexArrayChanges = 0;
+        double sortSeconds = 0.0;
+    };
+
+    // @brief Create an empty queue
+    // @param nearPlane Closest depth that is told apart, normally the near plane
+    // @param farPlane  Farthest depth that is told apart, normally the far plane
+    RenderQueue(float nearPlane = 0.1f, float farPlane = 100.0f);
+
+    // @brief Queue a single draw of a mesh with its own model matrix, uploaded to the "model" uniform
+    // @param pass   Pass to draw in
+    // @param shader Program to draw with
+    // @param mesh   Mesh to draw
+    // @param model  Model matrix of the draw
+    // @param depth  View space distance used for ordering
+    void submit(RenderPass pass, Shader& shader, Mesh& mesh, const glm::mat4& model, float depth) {
+        _commands.submit(pass, shader, mesh, model, depth);
+    }
+
+    // @brief Queue an instanced draw of a mesh whose transforms live in an instance buffer
+    // @param pass          Pass to draw in
+    // @param shader        Program to draw with
+    // @param mesh          Mesh to draw
+    // @param instanceCount Number of instances
+    // @param depth         View space distance used for ordering
+    void submitInstanced(RenderPass pass, Shader& shader, Mesh& mesh, size_t instanceCount, float depth) {
+        _commands.submitInstanced(pass, shader, mesh, instanceCount, depth);
+    }
+
+    // @brief Queue a GPU culled multi-draw; the list must have been culled this frame
+    // @param pass   Pass to draw in
+    // @param shader Program to draw with
+    // @param mesh   Mesh the list was built for
+    // @param list   Objects to draw
+    // @param depth  View space distance used for ordering
+    void submitIndirect(RenderPass pass, Shader& shader, Mesh& mesh, IndirectDrawList& list, float depth) {
+        _commands.submitIndirect(pass, shader, mesh, list, depth);
+    }
+
+    // @brief Include a recorded buffer in the next flush. The buffer is only read, and must stay
+    //        unchanged until the flush returns.
+    void append(const CommandBuffer& buffer);
+
+    // @brief Merge the queued packets by key, replay them and empty the queue.
+    //        Per-frame uniforms must be set on each program before this.
+    void flush();
+
+    // @brief Number of queued packets
+    size_t size() const;
+
+    // @brief Counters of the last flush
+    const Stats& lastFlush() const { return _stats; }
+
+private:
+
+    // @brief A packet of one of the buffers being merged
+    struct PacketRef {
+        const CommandBuffer* buffer;
+        uint32_t packet;
+    };
+
+    CommandBuffer _commands;
+    std::vector<const CommandBuffer*> _appended;
+
+    std::vector<PacketRef> _packets;
+    std::vector<uint64_t> _keys;
+    std::vector<uint32_t> _order;
+    std::vector<uint64_t> _keyScratch;
+    std::vector<uint32_t> _orderScratch;
+
+    Stats _stats;
+
+    // @brief Add every packet of a buffer to the merge
+    void gather(const CommandBuffer& buffer);
+};
+
+#endif // __RENDER_QUEUE_H__
@@ -0,0 +1,76 @@
+#ifndef __SCENE_SYSTEMS_H__
+#define __SCENE_SYSTEMS_H__
+
+#include <stdint.h>
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "CommandBuffer.h"
+#include "EntityStore.h"
+#include "FrustumCulling.h"
+#include "InstanceBuffer.h"
+#include "LightBlock.h"
+
+// Systems over an EntityStore. Each walks the columns of the matching archetypes front to back.
+// The update, cull and record systems split their rows across the job system; the ones writing to
+// a shared output run on the calling thread.
+
+// @brief Move entities with an Orbit to their position at a point in time
+// @param store Entities to update
+// @param time  Seconds since the start
+void updateOrbits(EntityStore& store, float time);
+
+// @brief Keep every transform as the state before the next simulation step; call before each step
+// @param store Entities to update
+void saveTransforms(EntityStore& store);
+
+// @brief Build the model and normal matrix of every transform, blended between the state saved by
+//        saveTransforms and the current one. Archetypes without a saved state use the current one.
+// @param store Entities to update
+// @param alpha Fraction of the way from the saved to the current state
+void updateTransforms(EntityStore& store, float alpha = 1.0f);
+
+// @brief Move bounding spheres to world space, bumping Archetype::boundsVersion of every archetype
+//        where one changed; run after updateTransforms
+// @param store Entities to update
+void updateBounds(EntityStore& store);
+
+// @brief List the rows of each bounded archetype whose sphere touches the view frustum, see
+//        Archetype::visibleRow. Archetypes whose rows and bounds are unchanged since they were
+//        culled with the same camera version keep their list.
+// @param store         Entities to cull
+// @param frustum       View frustum of the camera
+// @param cameraVersion Camera::version() the frustum belongs to
+void cullBounds(EntityStore& store, const Frustum& frustum, uint64_t cameraVersion);
+
+// @brief Copy the point lights into a light block at their entity's drawn translation; run after
+//        updateTransforms
+// @param store  Entities holding the lights
+// @param lights Block to fill; slots beyond the lights found are cleared
+// @return Number of lights written, at most MAX_POINT_LIGHTS
+unsigned int writePointLights(EntityStore& store, LightBlock& lights);
+
+// @brief Record every visible renderable that is not part of an instance batch, on all job threads
+// @param store          Entities to draw
+// @param cameraPosition World space position of the camera, for the depth of each draw
+// @param buffers        One buffer per job thread, indexed by JobSystem::threadIndex(); call from
+//                       a thread of the pool
+void recordRenderables(EntityStore& store, const glm::vec3& cameraPosition, std::vector<CommandBuffer>& buffers);
+
+// @brief Append the instance data of every visible entity in a batch; all of them before the first
+//        cullBounds
+// @param store     Entities to collect from
+// @param batch     Instance batch
+// @param instances List the model and normal matrices are appended to
+void gatherInstances(EntityStore& store, uint32_t batch, std::vector<InstanceData>& instances);
+
+// @brief Distance from the camera to the nearest visible bounding sphere of a batch
+// @param store          Entities to search
+// @param batch          Instance batch
+// @param cameraPosition World space position of the camera
+// @param farPlane       Returned when no entity of the batch is visible
+float nearestInBatch(EntityStore& store, uint32_t batch, const glm::vec3& cameraPosition, float farPlane);
+
+#endif // __SCENE_SYSTEMS_H__
@@ -5,7 +5,12 @@
 
 #include <stdint.h>
 
+#include <chrono>
+#include <cstring>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -13,6 +18,13 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "GLState.h"
+#include "Uniform.h"
+#include "UniformTable.h"
+
+class ProgramCache;
+class ShaderDefines;
+
 class Shader {
 public:
 
@@ -22,7 +34,37 @@ public:
     // @brief Construct a shader program from vertex and fragment shader source files
     // @param vertex_path   Path to the vertex shader source file
     // @param fragment_path Path to the fragment shader source file
-    Shader(const char* vertex_path, const char* fragment_path);
+    // @param cache         Optional program binary cache to load from and save to
+    Shader(const char* vertex_path, const char* fragment_path, ProgramCache* cache = nullptr);
+
+    // Tag selecting the non-blocking constructor
+    struct Deferred {};
+
+    // @brief Submit a shader program for compilation without waiting for the driver.
+    //        The program is usable once isReady() is true; use() blocks until then.
+    // @param vertex_path   Path to the vertex shader source file
+    // @param fragment_path Path to the fragment shader source file
+    // @param cache         Program binary cache to load from and save to, may be null
+    Shader(const char* vertex_path, const char* fragment_path, ProgramCache* cache, Deferred);
+
+    // @brief Submit a permutation of a shader program built with extra defines
+    // @param vertex_path   Path to the vertex shader source file
+    // @param fragment_path Path to the fragment shader source file
+    // @param defines       Defines injected after #version in both stages
+    // @param cache         Program binary cache to load from and save to, may be null
+    Shader(const char* vertex_path, const char* fragment_path, const ShaderDefines& defines,
+           ProgramCache* cache, Deferred);
+
+    // @brief Whether the program has been linked and its status checked
+    bool isReady() const { return _ready; }
+
+    // @brief Finish the program if the driver has completed it, without blocking.
+    //        Only returns true before wait() when KHR_parallel_shader_compile is available.
+    // @return Whether the program is ready
+    bool poll();
+
+    // @brief Block until the program is linked, then report errors and gather its uniforms
+    void wait();
 
     // @brief Activate the shader
     void use();
@@ -30,34 +72,105 @@ public:
     // @brief Delete the shader
     void deleteShader();
 
+    // @brief Look up the location of a uniform without querying the driver
+    // @param name Name of the uniform variable
+    // @return Location of the uniform, or -1 if it is not active in the program
+    int getUniformLocation(std::string_view name) const { return _uniforms.find(name); }
+
     // @brief Set a boolean uniform in the shader
     // @param name  Name of the uniform variable
     // @param value Boolean value to set
-    void setBool(const std::string& name, bool value) const;
+    void setBool(std::string_view name, bool value) const;
 
     // @brief Set an integer uniform in the shader
     // @param name  Name of the uniform variable
     // @param value Integer value to set
-    void setInt(const std::string& name, int value) const;
+    void setInt(std::string_view name, int value) const;
 
     // @brief Set a float uniform in the shader
     // @param name  Name of the uniform variable
     // @param value Float value to set
-    void setFloat(const std::string& name, float value) const;
+    void setFloat(std::string_view name, float value) const;
 
     // @brief Set a 4x4 matrix uniform in the shader
     // @param name  Name of the uniform variable
     // @param value Reference to a glm::mat4 representing the matrix
-    void setMat4(const std::string& name, const glm::mat4 value) const;
+    void setMat4(std::string_view name, const glm::mat4 value) const;
 
     // @brief Set a 3x3 matrix uniform in the shader
     // @param name  Name of the uniform variable
     // @param value Reference to a glm::mat3 representing the matrix
-    void setMat3(const std::string& name, const glm::mat3 value) const;
+    void setMat3(std::string_view name, const glm::mat3 value) const;
 
     // @brief Set a 3-component vector uniform in the shader
     // @param name Name of the uniform variable
     // @param value Reference to a glm::vec3 representing the vector
-    void setVec3(const std::string& name, const glm::vec3 value) const;
+    void setVec3(std::string_view name, const glm::vec3 value) const;
+
+    // @brief Set a uniform through a precompiled handle, without allocating or hashing
+    // @param uniform Handle to the uniform variable, resolved against this program on first use
+    // @param value   Value to set
+    template <typename T>
+    void set(Uniform<T>& uniform, const std::type_identity_t<T>& value) const {
+        write(uniform.location(_uniforms), value);
+    }
+
+    // @brief Look up the location of a uniform through a precompiled handle. Safe on any thread once
+    //        the program is ready, as long as each thread uses its own handle.
+    // @param uniform Handle to the uniform variable
+    // @return Location of the uniform, or -1 if it is not active in the program
+    template <typename T>
+    int getUniformLocation(Uniform<T>& uniform) const { return uniform.location(_uniforms); }
+
+    // @brief Set a uniform at a location looked up earlier, e.g. by a recorded command
+    // @param location Location from getUniformLocation
+    // @param value    Value to set
+    template <typename T>
+    void setUniform(int location, const T& value) const { write(location, value); }
+
+private:
+
+    // Locations of every active uniform, gathered once after linking
+    UniformTable _uniforms;
+
+    // Last value written to each uniform location, indexed by location
+    struct UniformShadow {
+        bool valid = false;
+        alignas(16) unsigned char data[64];
+    };
+    mutable std::vector<UniformShadow> _shadow;
+
+    // In-flight build state, released by wait()
+    unsigned int _vertex = 0;
+    unsigned int _fragment = 0;
+    bool _ready = false;
+    ProgramCache* _cache = nullptr;
+    uint64_t _cacheKey = 0;
+    std::chrono::steady_clock::time_point _buildStart;
+
+    /// @brief Upload a uniform unless it already holds the value. Assumes this program is bound.
+    template <typename T>
+    void write(int location, const T& value) const {
+        static_assert(sizeof(T) <= sizeof(UniformShadow::data), "uniform value too large to shadow");
+        if (location < 0)
+            return;
+        if ((size_t)location < _shadow.size()) {
+            UniformShadow& shadow = _shadow[location];
+            if (shadow.valid && std::memcmp(shadow.data, &value, sizeof(T)) == 0) {
+                glState.countUniform(true);
+                return;
+            }
+            std::memcpy(shadow.data, &value, sizeof(T));
+            shadow.valid = true;
+        }
+        glState.countUniform(false);
+        uploadUniform(location, value);
+    }
+
+    /// @brief Size the uniform value shadow from the uniform table
+    void resetShadow();
+
+    /// @brief Attach the shared uniform blocks the program declares to their fixed binding points
+    void bindUniformBlocks();
 };
 #endif // __SHADER_H__
\ No newline at end of file
@@ -0,0 +1,43 @@
+#ifndef __SHADER_COMPILER_H__
+#define __SHADER_COMPILER_H__
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "Shader.h"
+
+// @brief Warm-up queue for programs submitted with Shader::Deferred.
+//        Programs are finished as the driver completes them so they are
+//        ready before their first draw, instead of stalling inside use().
+class ShaderCompiler {
+public:
+
+    // @brief Construct a compiler, letting the driver use as many compile threads as it likes
+    ShaderCompiler();
+
+    // @brief Add a submitted program to the queue. The shader must outlive the queue entry.
+    // @param shader Shader constructed with Shader::Deferred
+    void enqueue(Shader& shader);
+
+    // @brief Finish programs that are ready, called once per frame.
+    //        Without KHR_parallel_shader_compile there is no way to tell whether
+    //        the driver is done, so up to maxBlocking programs are waited on instead.
+    // @param maxBlocking Maximum number of programs that may block this call
+    // @return Number of programs finished
+    size_t update(size_t maxBlocking = 1);
+
+    // @brief Block until every queued program is finished
+    void finish();
+
+    // @brief Whether every queued program is finished
+    bool isReady() const { return _pending.empty(); }
+
+    // @brief Number of programs still in flight
+    size_t pending() const { return _pending.size(); }
+
+private:
+
+    std::vector<Shader*> _pending;
+};
+#endif // __SHADER_COMPILER_H__
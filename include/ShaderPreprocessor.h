@@ -0,0 +1,49 @@
+#ifndef __SHADER_PREPROCESSOR_H__
+#define __SHADER_PREPROCESSOR_H__
+
+#include <map>
+#include <string>
+
+// @brief Set of #defines a shader permutation is built with
+class ShaderDefines {
+public:
+
+    // @brief Set a define, replacing any previous value
+    // @param name  Name of the macro
+    // @param value Replacement text of the macro
+    ShaderDefines& set(const std::string& name, const std::string& value = "1");
+
+    // @brief Set a define to an integer value
+    // @param name  Name of the macro
+    // @param value Value of the macro
+    ShaderDefines& set(const std::string& name, int value);
+
+    // @brief Set every define of another set, replacing previous values
+    // @param other Defines to copy
+    ShaderDefines& set(const ShaderDefines& other);
+
+    // @brief Remove a define
+    // @param name Name of the macro
+    ShaderDefines& unset(const std::string& name);
+
+    // @brief The defines as GLSL #define lines, sorted by name so equal sets give equal strings.
+    //        Doubles as the permutation key.
+    std::string str() const;
+
+private:
+
+    std::map<std::string, std::string> _values;
+};
+
+// @brief Load a shader source file, expanding #include "file" directives and
+//        inserting the defines right after #version. Paths are relative to the
+//        including file and each file is included at most once. #line directives
+//        keep compiler messages pointing at the original line; the source string
+//        number is the order in which files were first opened, the root being 0.
+// @param path    Path to the shader source file
+// @param defines Defines to inject
+// @param output  Receives the expanded source
+// @return Whether every file could be read
+bool preprocessShader(const std::string& path, const ShaderDefines& defines, std::string& output);
+
+#endif // __SHADER_PREPROCESSOR_H__
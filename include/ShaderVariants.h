@@ -0,0 +1,58 @@
+#ifndef __SHADER_VARIANTS_H__
+#define __SHADER_VARIANTS_H__
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "Shader.h"
+#include "ShaderPreprocessor.h"
+
+class ProgramCache;
+class ShaderCompiler;
+
+// @brief Permutation cache for one pair of shader source files.
+//        Each distinct define set is built once into its own specialized
+//        program, so the GLSL compiler can strip code the permutation never uses.
+//        Every define the sources test is passed explicitly: one a permutation
+//        leaves unset takes its default, so the sources need no fallbacks.
+class ShaderVariants {
+public:
+
+    // @brief Construct an empty permutation cache
+    // @param vertex_path   Path to the vertex shader source file
+    // @param fragment_path Path to the fragment shader source file
+    // @param defaults      Every define the sources test, with the value used when a permutation
+    //                      leaves it unset, e.g. 0 for a feature that is off
+    // @param cache         Program binary cache shared by every permutation, may be null
+    // @param compiler      Warm-up queue new permutations are submitted to, may be null
+    ShaderVariants(const char* vertex_path, const char* fragment_path, const ShaderDefines& defaults,
+                   ProgramCache* cache = nullptr, ShaderCompiler* compiler = nullptr);
+
+    ShaderVariants(const ShaderVariants&) = delete;
+    ShaderVariants& operator=(const ShaderVariants&) = delete;
+
+    // @brief Get the program for a define set, submitting it if it was never requested.
+    //        Call early to warm a permutation up before its first draw; with a
+    //        compiler the returned shader may not be ready yet.
+    // @param defines Defines of the permutation, over the defaults
+    Shader& get(const ShaderDefines& defines);
+
+    // @brief Delete every program built so far; the compiler must not still hold any of them
+    void deleteShaders();
+
+    // @brief Number of permutations built so far
+    size_t size() const { return _variants.size(); }
+
+private:
+
+    std::string _vertexPath;
+    std::string _fragmentPath;
+    ShaderDefines _defaults;
+    ProgramCache* _cache;
+    ShaderCompiler* _compiler;
+
+    // unique_ptr keeps each Shader at a stable address for the compiler queue
+    std::unordered_map<std::string, std::unique_ptr<Shader>> _variants;
+};
+#endif // __SHADER_VARIANTS_H__
@@ -0,0 +1,90 @@
+#ifndef __TRANSFORM_BATCH_H__
+#define __TRANSFORM_BATCH_H__
+
+#include <stddef.h>
+
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "InstanceBuffer.h"
+
+// @brief Instance transforms stored as structure-of-arrays translation, rotation and scale.
+//        Model and normal matrices are produced in batches by SIMD kernels; since every
+//        transform is a TRS the normal matrix is R * S^-1 and no general inverse is needed.
+class TransformBatch {
+public:
+
+    // @brief Add an instance
+    // @param translation World space position of the instance
+    // @param rotation    Unit quaternion orientation of the instance
+    // @param scale       Scale along each local axis, must not be zero
+    // @return Index of the new instance
+    size_t add(const glm::vec3& translation, const glm::quat& rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+               const glm::vec3& scale = glm::vec3(1.0f));
+
+    // @brief Move an instance
+    void setTranslation(size_t index, const glm::vec3& translation);
+
+    // @brief Rotate an instance
+    void setRotation(size_t index, const glm::quat& rotation);
+
+    // @brief Scale an instance
+    void setScale(size_t index, const glm::vec3& scale);
+
+    // @brief Remove an instance by moving the last one into its place
+    void remove(size_t index);
+
+    glm::vec3 translation(size_t index) const { return glm::vec3(_tx[index], _ty[index], _tz[index]); }
+    glm::quat rotation(size_t index) const { return glm::quat(_qw[index], _qx[index], _qy[index], _qz[index]); }
+    glm::vec3 scale(size_t index) const { return glm::vec3(_sx[index], _sy[index], _sz[index]); }
+
+    // @brief Remove every instance
+    void clear();
+
+    // @brief Grow or shrink the batch; added instances are identity transforms
+    void resize(size_t count);
+
+    // @brief Set the instances in [begin, end) to a blend of the same instances of two batches:
+    //        translation and scale linearly, rotation by normalized linear interpolation along the
+    //        shorter arc. Instances equal in both batches are copied unchanged.
+    // @param from  State at alpha 0, e.g. the previous simulation step
+    // @param to    State at alpha 1, with as many instances as from
+    // @param alpha Blend factor in [0, 1]
+    // @param begin First instance, which this batch must already hold
+    // @param end   One past the last instance
+    void blend(const TransformBatch& from, const TransformBatch& to, float alpha, size_t begin, size_t end);
+
+    // @brief Number of instances in the batch
+    size_t size() const { return _tx.size(); }
+
+    // @brief Write the model and normal matrix of every instance, using AVX2 or SSE when available.
+    //        Groups whose instances are all translation-only skip the rotation and scale math.
+    // @param out Destination holding at least size() instances
+    void computeInstances(InstanceData* out) const { computeInstances(out, 0, size()); }
+
+    // @brief Write the instances in [begin, end) only, e.g. one job's share of the batch
+    // @param out Destination holding at least size() instances, indexed like the batch
+    void computeInstances(InstanceData* out, size_t begin, size_t end) const;
+
+    // @brief Reference implementation of computeInstances without SIMD
+    // @param out Destination holding at least size() instances
+    void computeInstancesScalar(InstanceData* out) const;
+
+    // @brief Name of the kernel computeInstances uses on this machine: "avx2", "sse" or "scalar"
+    static const char* kernelName();
+
+private:
+
+    // translation
+    std::vector<float> _tx, _ty, _tz;
+    // rotation quaternion
+    std::vector<float> _qx, _qy, _qz, _qw;
+    // scale
+    std::vector<float> _sx, _sy, _sz;
+
+    /// @brief Scalar kernel over the range [begin, end)
+    void computeRange(size_t begin, size_t end, InstanceData* out) const;
+};
+#endif // __TRANSFORM_BATCH_H__
@@ -0,0 +1,63 @@
+#ifndef __UNIFORM_H__
+#define __UNIFORM_H__
+
+#include <glad/gl.h>
+
+#include <stdint.h>
+
+#include <string_view>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "UniformTable.h"
+
+// @brief Typed handle to a uniform whose name is hashed at compile time.
+//        The location is resolved against a program's UniformTable the first
+//        time the handle is used with it and cached until a different table is seen,
+//        so setting a value never allocates, hashes or queries the driver.
+template <typename T>
+class Uniform {
+public:
+
+    // @brief Construct a handle, hashing the name at compile time
+    // @param name Name of the uniform variable
+    consteval explicit Uniform(std::string_view name) : _hash(hashUniformName(name)) {}
+
+    // @brief Location of the uniform in the program owning the table
+    // @param table Uniform table of the program being written to
+    int location(const UniformTable& table) {
+        if (_stamp != table.stamp()) {
+            _location = table.find(_hash);
+            _stamp = table.stamp();
+        }
+        return _location;
+    }
+
+    // @brief Hash of the uniform name
+    uint64_t hash() const { return _hash; }
+
+private:
+
+    uint64_t _hash;
+    uint32_t _stamp = 0;
+    int _location = -1;
+};
+
+// @brief Upload a uniform value to the currently bound program
+// @param location Location of the uniform variable
+// @param value    Value to set
+inline void uploadUniform(int location, bool value) { glUniform1i(location, (int)value); }
+inline void uploadUniform(int location, int value) { glUniform1i(location, value); }
+inline void uploadUniform(int location, float value) { glUniform1f(location, value); }
+inline void uploadUniform(int location, const glm::vec2& value) { glUniform2f(location, value.x, value.y); }
+inline void uploadUniform(int location, const glm::vec3& value) {
+    glUniform3f(location, value.x, value.y, value.z);
+}
+inline void uploadUniform(int location, const glm::mat3& value) {
+    glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(value));
+}
+inline void uploadUniform(int location, const glm::mat4& value) {
+    glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
+}
+#endif // __UNIFORM_H__
@@ -0,0 +1,78 @@
+#ifndef __UNIFORM_TABLE_H__
+#define __UNIFORM_TABLE_H__
+
+#include <stdint.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// @brief 64-bit FNV-1a hash of a uniform name
+// @param name Name of the uniform variable
+constexpr uint64_t hashUniformName(std::string_view name) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (char c : name) {
+        hash ^= (uint8_t)c;
+        hash *= 0x100000001b3ull;
+    }
+    return hash ? hash : 1;                                 // 0 is reserved for empty table slots
+}
+
+class UniformTable {
+public:
+
+    // @brief Populate the table with every active uniform of a linked program
+    // @param program ID of a successfully linked shader program
+    void build(unsigned int program);
+
+    // @brief Remove every entry from the table
+    void clear();
+
+    // @brief Find the location of a uniform by its precomputed name hash
+    // @param hash Hash of the uniform name from hashUniformName
+    // @return Location of the uniform, or -1 if the program has no such uniform
+    int find(uint64_t hash) const {
+        if (_slots.empty())
+            return -1;
+
+        size_t mask = _slots.size() - 1;
+        for (size_t i = hash & mask;; i = (i + 1) & mask) {
+            const Slot& slot = _slots[i];
+            if (slot.hash == hash)
+                return slot.location;
+            if (slot.hash == 0)
+                return -1;
+        }
+    }
+
+    // @brief Find the location of a uniform by name
+    // @param name Name of the uniform variable
+    int find(std::string_view name) const { return find(hashUniformName(name)); }
+
+    // @brief Number of uniform names held in the table
+    size_t size() const { return _count; }
+
+    // @brief Highest location held in the table, or -1 when it is empty
+    int maxLocation() const { return _maxLocation; }
+
+    // @brief Identifier that changes whenever the table is rebuilt or cleared, used by Uniform handles to detect a different program
+    uint32_t stamp() const { return _stamp; }
+
+private:
+
+    // Hashes and locations are packed together so a probe touches a single cache line
+    struct Slot {
+        uint64_t hash = 0;                                  // 0 marks an empty slot
+        int location = -1;
+    };
+
+    std::vector<Slot> _slots;
+    std::vector<std::string> _names;                        // parallel to _slots, only read while building
+    size_t _count = 0;
+    int _maxLocation = -1;
+    uint32_t _stamp = 0;                                    // 0 until the table is first built
+
+    /// @brief Insert a name into the table, growing it when over half full
+    void insert(const std::string& name, int location);
+};
+#endif // __UNIFORM_TABLE_H__
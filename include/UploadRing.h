@@ -0,0 +1,97 @@
+#ifndef __UPLOAD_RING_H__
+#define __UPLOAD_RING_H__
+
+#include <glad/gl.h>
+
+#include <stddef.h>
+
+// @brief Buffer for data rewritten every frame, split into one section per frame in flight.
+//        Each frame writes straight into mapped memory and binds ranges of its own section; a
+//        fence per section stops the CPU from overwriting data the GPU has not read yet.
+//
+//        With ARB_buffer_storage the buffer stays persistently and coherently mapped. Otherwise
+//        each section is mapped unsynchronized in beginFrame() and unmapped in finishWrites(),
+//        since a mapped buffer cannot be drawn from without the persistent bit.
+//
+//        Per frame: beginFrame(), allocate and write, finishWrites(), draw, endFrame().
+class UploadRing {
+public:
+
+    // Sections in the ring; the CPU can be this many frames ahead of the GPU
+    static const unsigned int FRAMES = 3;
+
+    // @brief Counters of one frame
+    struct Stats {
+        double fenceWaitSeconds = 0.0;                      // CPU time blocked waiting for the GPU to release a section
+        size_t bytesUploaded = 0;                           // bytes allocated, including alignment padding
+    };
+
+    // @brief Range of the current section handed out by allocate()
+    struct Allocation {
+        void* data = nullptr;                               // mapped memory to write, null if the section is full
+        GLintptr offset = 0;                                // offset in the buffer, for glBindBufferRange
+        GLsizeiptr size = 0;
+    };
+
+    // buffer object ID
+    unsigned int ID;
+
+    // @brief Create the buffer
+    // @param bytes_per_frame Size of each section
+    UploadRing(size_t bytes_per_frame);
+
+    // @brief Wait until the next section is free and start writing to it
+    void beginFrame();
+
+    // @brief Reserve memory in the current section
+    // @param size      Number of bytes
+    // @param alignment Required alignment of the offset, e.g. GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+    Allocation allocate(size_t size, size_t alignment);
+
+    // @brief Reserve memory for a uniform block and bind it to a uniform buffer binding point
+    // @param binding Binding point of the block
+    // @return Mapped memory to write the block to, null if the section is full
+    template <typename T>
+    T* allocateUniformBlock(unsigned int binding) {
+        Allocation allocation = allocate(sizeof(T), _uniformAlignment);
+        bindRange(GL_UNIFORM_BUFFER, binding, allocation);
+        return (T*)allocation.data;
+    }
+
+    // @brief Bind an allocation to an indexed buffer binding point
+    // @param target  Indexed target, e.g. GL_UNIFORM_BUFFER
+    // @param index   Binding point
+    // @param range   Allocation from the current section
+    void bindRange(GLenum target, unsigned int index, const Allocation& range);
+
+    // @brief Make the writes of the current section visible to the GPU; must come before the draws reading it
+    void finishWrites();
+
+    // @brief Fence the current section after the draws reading it were issued
+    void endFrame();
+
+    // @brief Whether the buffer is persistently mapped rather than mapped every frame
+    bool persistent() const { return _persistent; }
+
+    // @brief Counters of the last complete frame
+    const Stats& lastFrame() const { return _lastFrame; }
+
+    // @brief Delete the buffer and the pending fences
+    void deleteBuffer();
+
+private:
+    size_t _sectionSize;
+    size_t _uniformAlignment;
+    bool _persistent;
+
+    unsigned char* _mapped = nullptr;                       // whole buffer when persistent, current section otherwise
+    GLsync _fences[FRAMES] = {};
+    unsigned int _frame = 0;
+    size_t _head = 0;
+    bool _writing = false;
+
+    Stats _current;
+    Stats _lastFrame;
+};
+
+#endif // __UPLOAD_RING_H__
@@ -0,0 +1,57 @@
+#ifndef __VERTEX_FORMAT_H__
+#define __VERTEX_FORMAT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// @brief Vertex of a mesh as authored, encoded for attribute locations 0-2 of shaders/shader.vs by encodeVertices
+struct Vertex {
+	glm::vec3 Position;
+	glm::vec3 Normal;
+	glm::vec2 TexCoords;
+};
+
+// @brief GPU vertex layouts, decoded in shaders/vertex.glsl
+enum class VertexFormat {
+	Float,				// 32 bytes: float position, normal and texture coordinates
+	Packed,				// 20 bytes: float position, 2_10_10_10 normal, half float texture coordinates
+	Quantized			// 16 bytes: 16-bit position relative to the mesh bounds, 2_10_10_10 normal, half float texture coordinates
+};
+
+// @brief Vertices encoded in one of the GPU vertex layouts
+struct EncodedVertices {
+	VertexFormat format = VertexFormat::Float;
+	size_t stride = 0;
+	std::vector<uint8_t> data;
+
+	// decoded position = positionOffset + stored position * positionScale
+	glm::vec3 positionOffset = glm::vec3(0.0f);
+	glm::vec3 positionScale = glm::vec3(1.0f);
+};
+
+// @brief Pick the smallest layout that represents the vertices without visible loss
+// @param vertices The vertices to encode
+VertexFormat chooseVertexFormat(const std::vector<Vertex>& vertices);
+
+// @brief Size of one vertex in a layout
+// @param format The vertex layout
+size_t vertexFormatStride(VertexFormat format);
+
+// @brief Encode vertices in a layout
+// @param vertices The vertices to encode
+// @param format The layout to encode them in
+EncodedVertices encodeVertices(const std::vector<Vertex>& vertices, VertexFormat format);
+
+// @brief Describe attribute locations 0-2 of the encoded vertices in the bound vertex array
+//        object, reading from the buffer bound to GL_ARRAY_BUFFER
+// @param format The layout of the buffer
+void setVertexAttributes(VertexFormat format);
+
+// @brief Human readable name of a layout
+const char* vertexFormatName(VertexFormat format);
+
+#endif // __VERTEX_FORMAT_H__
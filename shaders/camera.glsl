@@ -0,0 +1,8 @@
+// Per-frame camera data, written once per frame by CameraUniformBuffer.
+// Must stay in sync with the CameraBlock struct in include/CameraBlock.h.
+layout (std140) uniform CameraBlock {
+	mat4 view;
+	mat4 projection;
+	mat4 viewProjection;
+	vec4 cameraPosition;			// xyz = world space position, w unused
+};
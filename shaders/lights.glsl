@@ -0,0 +1,105 @@
+// Light types and their shading functions, shared by every lit fragment shader.
+// Expects FragPos, Normal, TexCoords, material and the CameraBlock to be declared by the includer,
+// and declares the LightBlock itself.
+
+// std140 layouts, each vec3 shares its slot with the float after it.
+// Must stay in sync with the structs in include/LightBlock.h.
+struct PointLight {
+	vec3 position;
+	float constant;
+	vec3 ambient;
+	float linear;
+	vec3 diffuse;
+	float quadratic;
+	vec3 specular;
+};
+
+struct DirectionalLight {
+	vec3 direction;
+	vec3 ambient;
+	vec3 diffuse;
+	vec3 specular;
+};
+
+struct SpotLight {
+	vec3 position;
+	float cutOff;
+	vec3 direction;
+	float constant;
+	vec3 ambient;
+	float linear;
+	vec3 diffuse;
+	float quadratic;
+	vec3 specular;
+};
+
+#define MAX_POINT_LIGHTS 4
+
+// Every light, written once per frame into the upload ring. Permutations read the first
+// NUM_POINT_LIGHTS point lights and skip the light types they were built without.
+layout (std140) uniform LightBlock {
+	PointLight pointLights[MAX_POINT_LIGHTS];
+	DirectionalLight dirLight;
+	SpotLight spotLight;
+};
+
+// specular colour of the material, constant black when it has no specular map
+vec3 SpecularSample() {
+#if HAS_SPECULAR_MAP
+	return vec3(texture(material.specular, TexCoords));
+#else
+	return vec3(0.0);
+#endif
+}
+
+vec3 CalcPointLight(PointLight light) {
+	vec3 lightDir = normalize(light.position - FragPos);
+	// diffuse shading
+	float diff = max(dot(Normal, lightDir), 0.0);
+	// specular shading
+	vec3 viewDir = normalize(cameraPosition.xyz - FragPos);
+	vec3 reflectDir = reflect(-lightDir, Normal);
+	float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+	// combine results
+	vec3 ambient = light.ambient * vec3(texture(material.diffuse, TexCoords));
+	vec3 diffuse = light.diffuse * diff * vec3(texture(material.diffuse, TexCoords));
+	vec3 specular = light.specular * spec * SpecularSample();
+	return (ambient + diffuse + specular);
+}
+
+vec3 CalcDirLight(DirectionalLight light) {
+	vec3 lightDir = normalize(-light.direction);
+	// diffuse shading
+	float diff = max(dot(Normal, lightDir), 0.0);
+	// specular shading
+	vec3 viewDir = normalize(cameraPosition.xyz - FragPos);
+	vec3 reflectDir = reflect(-lightDir, Normal);
+	float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+	// combine results
+	vec3 ambient = light.ambient * vec3(texture(material.diffuse, TexCoords));
+	vec3 diffuse = light.diffuse * diff * vec3(texture(material.diffuse, TexCoords));
+	vec3 specular = light.specular * spec * SpecularSample();
+	return (ambient + diffuse + specular);
+}
+
+vec3 CalcSpotLight(SpotLight light) {
+	vec3 lightDir = normalize(light.position - FragPos);
+	// diffuse shading
+	float diff = max(dot(Normal, lightDir), 0.0);
+	// specular shading
+	vec3 viewDir = normalize(cameraPosition.xyz - FragPos);
+	vec3 reflectDir = reflect(-lightDir, Normal);
+	float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+	// attenuation
+	float distance = length(light.position - FragPos);
+	float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));    
+	// spotlight intensity
+	float theta = dot(lightDir, normalize(-light.direction)); 
+	float epsilon = light.cutOff - 0.01;
+	float intensity = clamp((theta - epsilon) / (light.cutOff - epsilon), 0.0, 1.0);
+	// combine results
+	vec3 ambient = light.ambient * vec3(texture(material.diffuse, TexCoords));
+	vec3 diffuse = light.diffuse * diff * vec3(texture(material.diffuse, TexCoords));
+	vec3 specular = light.specular * spec * SpecularSample();
+	return (ambient + diffuse + specular) * attenuation * intensity;
+}
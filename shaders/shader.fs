@@ -1,46 +1,17 @@
 #version 330 core
 
+// Permutation defines, injected by ShaderVariants: NUM_POINT_LIGHTS, HAS_DIR_LIGHT, HAS_SPOT_LIGHT
+// and HAS_SPECULAR_MAP. Every one is always defined, 0 when the feature is off.
+
 // Fragment shader for lighting calculations
 struct Material {
 	sampler2D diffuse;
+#if HAS_SPECULAR_MAP
 	sampler2D specular;
+#endif
 	float shininess;
 };
 
-struct PointLight {
-	vec3 position;
-		
-	vec3 ambient;
-	vec3 diffuse;
-	vec3 specular;
-	
-	float constant;
-	float linear;
-	float quadratic;
-};
-
-struct DirectionalLight {
-	vec3 direction;
-		
-	vec3 ambient;
-	vec3 diffuse;
-	vec3 specular;
-};
-
-struct SpotLight {
-	vec3 position;
-	vec3 direction;
-	float cutOff;
-	
-	vec3 ambient;
-	vec3 diffuse;
-	vec3 specular;
-
-	float constant;
-	float linear;
-	float quadratic;
-};
-
 out vec4 FragColor;
 
 in vec3 Normal;
@@ -50,77 +21,31 @@ in vec2 TexCoords;
 uniform vec3 objectColor;
 uniform vec3 lightColor;
 
-// light properies
-uniform PointLight pointLight;
-uniform DirectionalLight dirLight;
-uniform SpotLight spotLight;
-
-uniform vec3 viewPos;
+#include "camera.glsl"
 
 // Material properties
 uniform Material material;
 
-vec3 CalcDirLight(DirectionalLight light);
-vec3 CalcPointLight(PointLight light);
-vec3 CalcSpotLight(SpotLight light);
-void main() {
+// light properties, in the LightBlock
+#include "lights.glsl"
 
-	vec3 spotLightResult = CalcSpotLight(spotLight);
-	vec3 dirLightResult = CalcDirLight(dirLight);
-	vec3 pointLightResult = CalcPointLight(pointLight);
+#if NUM_POINT_LIGHTS > MAX_POINT_LIGHTS
+#error NUM_POINT_LIGHTS exceeds the size of the LightBlock
+#endif
 
-	vec3 result = spotLightResult + dirLightResult + pointLightResult;
-	FragColor = vec4(result, 1.0); 																		// set all 4 vector values to 1.0
-}
+void main() {
 
-vec3 CalcPointLight(PointLight light) {
-	vec3 lightDir = normalize(light.position - FragPos);
-	// diffuse shading
-	float diff = max(dot(Normal, lightDir), 0.0);
-	// specular shading
-	vec3 viewDir = normalize(viewPos - FragPos);
-	vec3 reflectDir = reflect(-lightDir, Normal);
-	float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-	// combine results
-	vec3 ambient = light.ambient * vec3(texture(material.diffuse, TexCoords));
-	vec3 diffuse = light.diffuse * diff * vec3(texture(material.diffuse, TexCoords));
-	vec3 specular = light.specular * spec * vec3(texture(material.specular, TexCoords));
-	return (ambient + diffuse + specular);
-}
+	vec3 result = vec3(0.0);
+#if HAS_SPOT_LIGHT
+	result += CalcSpotLight(spotLight);
+#endif
+#if HAS_DIR_LIGHT
+	result += CalcDirLight(dirLight);
+#endif
+#if NUM_POINT_LIGHTS > 0
+	for (int i = 0; i < NUM_POINT_LIGHTS; i++)
+		result += CalcPointLight(pointLights[i]);
+#endif
 
-vec3 CalcDirLight(DirectionalLight light) {
-	vec3 lightDir = normalize(-light.direction);
-	// diffuse shading
-	float diff = max(dot(Normal, lightDir), 0.0);
-	// specular shading
-	vec3 viewDir = normalize(viewPos - FragPos);
-	vec3 reflectDir = reflect(-lightDir, Normal);
-	float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-	// combine results
-	vec3 ambient = light.ambient * vec3(texture(material.diffuse, TexCoords));
-	vec3 diffuse = light.diffuse * diff * vec3(texture(material.diffuse, TexCoords));
-	vec3 specular = light.specular * spec * vec3(texture(material.specular, TexCoords));
-	return (ambient + diffuse + specular);
+	FragColor = vec4(result, 1.0); 																		// set all 4 vector values to 1.0
 }
-
-vec3 CalcSpotLight(SpotLight light) {
-	vec3 lightDir = normalize(light.position - FragPos);
-	// diffuse shading
-	float diff = max(dot(Normal, lightDir), 0.0);
-	// specular shading
-	vec3 viewDir = normalize(viewPos - FragPos);
-	vec3 reflectDir = reflect(-lightDir, Normal);
-	float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-	// attenuation
-	float distance = length(light.position - FragPos);
-	float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));    
-	// spotlight intensity
-	float theta = dot(lightDir, normalize(-light.direction)); 
-	float epsilon = light.cutOff - 0.01;
-	float intensity = clamp((theta - epsilon) / (light.cutOff - epsilon), 0.0, 1.0);
-	// combine results
-	vec3 ambient = light.ambient * vec3(texture(material.diffuse, TexCoords));
-	vec3 diffuse = light.diffuse * diff * vec3(texture(material.diffuse, TexCoords));
-	vec3 specular = light.specular * spec * vec3(texture(material.specular, TexCoords));
-	return (ambient + diffuse + specular) * attenuation * intensity;
-}
\ No newline at end of file
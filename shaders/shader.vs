@@ -3,19 +3,22 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
 
+// per-instance transform, see InstanceData in include/InstanceBuffer.h
+layout (location = 3) in mat4 aModel;
+layout (location = 7) in mat3 aNormalMatrix;
+
 out vec3 Normal;
 out vec3 FragPos;
 out vec2 TexCoords;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-uniform mat3 normalMatrix;
+#include "camera.glsl"
+#include "vertex.glsl"
 
 void main() 
 {
-	FragPos = vec3(model * vec4(aPos, 1.0));
+	FragPos = vec3(aModel * vec4(decodePosition(aPos), 1.0));
 	TexCoords = aTexCoords;
-	Normal = normalMatrix * aNormal;
-    gl_Position = projection * view * model * vec4(aPos, 1.0);	
-}
\ No newline at end of file
+	// packed normals lose a little length to the 10-bit quantization
+	Normal = normalize(aNormalMatrix * aNormal);
+    gl_Position = viewProjection * vec4(FragPos, 1.0);	
+}
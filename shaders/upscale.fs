@@ -0,0 +1,35 @@
+#version 330 core
+
+in vec2 TexCoords;
+
+out vec4 FragColor;
+
+uniform sampler2D sceneTexture;
+uniform vec2 uvScale;		// part of sceneTexture the scene was rendered into
+uniform float sharpness;	// 0 is plain bilinear
+
+void main()
+{
+	// keep every tap inside the rendered region so nothing bleeds in from the unused part
+	vec2 texel = 1.0 / vec2(textureSize(sceneTexture, 0));
+	vec2 lo = 0.5 * texel;
+	vec2 hi = uvScale - 0.5 * texel;
+	vec2 uv = clamp(TexCoords * uvScale, lo, hi);
+
+	vec3 center = texture(sceneTexture, uv).rgb;
+	if (sharpness <= 0.0) {
+		FragColor = vec4(center, 1.0);
+		return;
+	}
+
+	vec3 north = texture(sceneTexture, clamp(uv + vec2(0.0, texel.y), lo, hi)).rgb;
+	vec3 south = texture(sceneTexture, clamp(uv - vec2(0.0, texel.y), lo, hi)).rgb;
+	vec3 east = texture(sceneTexture, clamp(uv + vec2(texel.x, 0.0), lo, hi)).rgb;
+	vec3 west = texture(sceneTexture, clamp(uv - vec2(texel.x, 0.0), lo, hi)).rgb;
+
+	// unsharp mask, limited to the range of the neighbourhood so edges do not ring
+	vec3 sharpened = center + sharpness * (4.0 * center - north - south - east - west);
+	vec3 lowest = min(center, min(min(north, south), min(east, west)));
+	vec3 highest = max(center, max(max(north, south), max(east, west)));
+	FragColor = vec4(clamp(sharpened, lowest, highest), 1.0);
+}
@@ -0,0 +1,9 @@
+// Decoding of the vertex layouts in include/VertexFormat.h. Normals and texture coordinates
+// are expanded by the attribute fetch; quantized positions are signed normalized offsets from
+// the centre of the mesh bounds. Mesh::Draw sets both uniforms for every layout.
+uniform vec3 positionOffset;
+uniform vec3 positionScale;
+
+vec3 decodePosition(vec3 position) {
+	return positionOffset + position * positionScale;
+}
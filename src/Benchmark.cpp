@@ -0,0 +1,549 @@
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string_view>
+#include <unordered_map>
+
+#include <glad/gl.h>
+#include <GLFW/glfw3.h>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Benchmark.h"
+#include "EntityStore.h"
+#include "FrustumCulling.h"
+#include "GLExtensions.h"
+#include "HeadlessContext.h"
+#include "JobSystem.h"
+#include "RenderQueue.h"
+#include "SceneSystems.h"
+#include "Shader.h"
+#include "ShaderPreprocessor.h"
+#include "TransformBatch.h"
+#include "UniformTable.h"
+
+static void printUsage(const char *program) {
+  std::cout << "usage: " << program
+            << " [--headless] [--job-benchmark] [--cull-benchmark] [--transform-benchmark]"
+               " [--sort-benchmark] [--uniform-benchmark] [--frames N] [--warmup N] [--width W] [--height H]"
+               " [--timestep SECONDS] [--budget MS] [--output PATH] [--trace PATH] [--trace-frames N]"
+            << std::endl;
+}
+
+bool parseBenchmarkOptions(int argc, char **argv, BenchmarkOptions &options) {
+  bool budgetGiven = false;
+  for (int i = 1; i < argc; i++) {
+    const char *flag = argv[i];
+    const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+    if (strcmp(flag, "--headless") == 0) {
+      options.headless = true;
+      continue;
+    }
+    if (strcmp(flag, "--job-benchmark") == 0) {
+      options.jobBenchmark = true;
+      continue;
+    }
+    if (strcmp(flag, "--cull-benchmark") == 0) {
+      options.cullBenchmark = true;
+      continue;
+    }
+    if (strcmp(flag, "--transform-benchmark") == 0) {
+      options.transformBenchmark = true;
+      continue;
+    }
+    if (strcmp(flag, "--sort-benchmark") == 0) {
+      options.sortBenchmark = true;
+      continue;
+    }
+    if (strcmp(flag, "--uniform-benchmark") == 0) {
+      options.uniformBenchmark = true;
+      continue;
+    }
+    if (strcmp(flag, "--help") == 0) {
+      printUsage(argv[0]);
+      return false;
+    }
+    if (!value) {
+      std::cout << "ERROR::BENCHMARK::MISSING_VALUE " << flag << std::endl;
+      printUsage(argv[0]);
+      return false;
+    }
+
+    bool valid = true;
+    if (strcmp(flag, "--frames") == 0)
+      valid = (options.frames = atoi(value)) > 0;
+    else if (strcmp(flag, "--warmup") == 0)
+      valid = (options.warmupFrames = atoi(value)) >= 0;
+    else if (strcmp(flag, "--width") == 0)
+      valid = (options.width = atoi(value)) > 0;
+    else if (strcmp(flag, "--height") == 0)
+      valid = (options.height = atoi(value)) > 0;
+    else if (strcmp(flag, "--timestep") == 0)
+      valid = (options.timestep = atof(value)) > 0.0;
+    else if (strcmp(flag, "--budget") == 0) {
+      valid = (options.budget = atof(value)) >= 0.0;
+      budgetGiven = true;
+    }
+    else if (strcmp(flag, "--output") == 0)
+      options.output = value;
+    else if (strcmp(flag, "--trace") == 0)
+      options.trace = value;
+    else if (strcmp(flag, "--trace-frames") == 0)
+      valid = (options.traceFrames = atoi(value)) > 0;
+    else
+      valid = false;
+
+    if (!valid) {
+      std::cout << "ERROR::BENCHMARK::INVALID_ARGUMENT " << flag << " " << value << std::endl;
+      printUsage(argv[0]);
+      return false;
+    }
+    i++;
+  }
+
+  // a benchmark measures a fixed amount of work unless a budget is asked for
+  if (options.headless && !budgetGiven)
+    options.budget = 0.0;
+  return true;
+}
+
+GPUFrameTimer::GPUFrameTimer() {
+  glGenQueries(QUERY_COUNT, _queries);
+}
+
+void GPUFrameTimer::begin(int frameIndex) {
+  // every query is in flight: give up on the oldest rather than wait for it
+  if (_pending[_next]) {
+    _pending[_next] = false;
+    _oldest = (_next + 1) % QUERY_COUNT;
+    _dropped++;
+  }
+  _frames[_next] = frameIndex;
+  glBeginQuery(GL_TIME_ELAPSED, _queries[_next]);
+}
+
+void GPUFrameTimer::end() {
+  glEndQuery(GL_TIME_ELAPSED);
+  _pending[_next] = true;
+  _next = (_next + 1) % QUERY_COUNT;
+}
+
+void GPUFrameTimer::collect(std::vector<double> &milliseconds, std::vector<int> &frames, bool wait) {
+  // results become available in submission order, so stop at the first pending one
+  while (_pending[_oldest]) {
+    if (!wait) {
+      GLint available = 0;
+      glGetQueryObjectiv(_queries[_oldest], GL_QUERY_RESULT_AVAILABLE, &available);
+      if (!available)
+        break;
+    }
+    GLuint64 nanoseconds = 0;
+    glGetQueryObjectui64v(_queries[_oldest], GL_QUERY_RESULT, &nanoseconds);
+    milliseconds.push_back((double)nanoseconds / 1.0e6);
+    frames.push_back(_frames[_oldest]);
+    _pending[_oldest] = false;
+    _oldest = (_oldest + 1) % QUERY_COUNT;
+  }
+}
+
+void GPUFrameTimer::deleteQueries() {
+  glDeleteQueries(QUERY_COUNT, _queries);
+}
+
+BenchmarkReport::Summary BenchmarkReport::summarize(const std::vector<double> &samples) {
+  Summary summary;
+  summary.count = samples.size();
+  if (samples.empty())
+    return summary;
+
+  std::vector<double> sorted(samples);
+  std::sort(sorted.begin(), sorted.end());
+
+  double total = 0.0;
+  for (double sample : sorted)
+    total += sample;
+
+  auto percentile = [&](double p) {
+    size_t rank = (size_t)std::ceil(p / 100.0 * (double)sorted.size());
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+  };
+
+  summary.mean = total / (double)sorted.size();
+  summary.min = sorted.front();
+  summary.max = sorted.back();
+  summary.p50 = percentile(50.0);
+  summary.p95 = percentile(95.0);
+  summary.p99 = percentile(99.0);
+  return summary;
+}
+
+static const char *rendererString() {
+  const char *renderer = (const char *)glGetString(GL_RENDERER);
+  return renderer ? renderer : "unknown";
+}
+
+static const char *versionString() {
+  const char *version = (const char *)glGetString(GL_VERSION);
+  return version ? version : "unknown";
+}
+
+std::string escapeJson(const char *text) {
+  std::string escaped;
+  for (const char *c = text; *c; c++) {
+    if (*c == '"' || *c == '\\')
+      escaped += '\\';
+    if ((unsigned char)*c >= 0x20)
+      escaped += *c;
+  }
+  return escaped;
+}
+
+static void writeJsonSummary(std::ostream &out, const char *name, const BenchmarkReport::Summary &summary,
+                             bool last) {
+  char line[256];
+  snprintf(line, sizeof(line),
+           "    \"%s\": {\"count\": %zu, \"mean\": %.4f, \"min\": %.4f, \"max\": %.4f, "
+           "\"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f}%s\n",
+           name, summary.count, summary.mean, summary.min, summary.max, summary.p50, summary.p95,
+           summary.p99, last ? "" : ",");
+  out << line;
+}
+
+static void writeCsvSummary(std::ostream &out, const char *name, const BenchmarkReport::Summary &summary,
+                            double budget, float scale) {
+  char line[256];
+  snprintf(line, sizeof(line), "%s,%zu,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\n", name, summary.count,
+           summary.mean, summary.min, summary.max, summary.p50, summary.p95, summary.p99, budget, scale);
+  out << line;
+}
+
+void BenchmarkReport::print(const BenchmarkOptions &options) const {
+  Summary cpu = summarize(cpuMilliseconds);
+  Summary gpu = summarize(gpuMilliseconds);
+  printf("%s, %dx%d, %zu frames\n", rendererString(), options.width, options.height, cpu.count);
+  printf("  cpu ms: mean %.3f  p50 %.3f  p95 %.3f  p99 %.3f  max %.3f\n", cpu.mean, cpu.p50, cpu.p95,
+         cpu.p99, cpu.max);
+  printf("  gpu ms: mean %.3f  p50 %.3f  p95 %.3f  p99 %.3f  max %.3f\n", gpu.mean, gpu.p50, gpu.p95,
+         gpu.p99, gpu.max);
+  printf("  final resolution scale %.3f (budget %.1f ms)\n", resolutionScale, options.budget);
+}
+
+bool BenchmarkReport::write(const std::string &path, const BenchmarkOptions &options) const {
+  std::ofstream out(path, std::ios::trunc);
+  if (!out) {
+    std::cout << "ERROR::BENCHMARK::FILE_NOT_WRITTEN " << path << std::endl;
+    return false;
+  }
+
+  Summary cpu = summarize(cpuMilliseconds);
+  Summary gpu = summarize(gpuMilliseconds);
+
+  bool csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+  if (csv) {
+    out << "metric,count,mean_ms,min_ms,max_ms,p50_ms,p95_ms,p99_ms,budget_ms,resolution_scale\n";
+    writeCsvSummary(out, "cpu_frame", cpu, options.budget, resolutionScale);
+    writeCsvSummary(out, "gpu_frame", gpu, options.budget, resolutionScale);
+  } else {
+    out << "{\n"
+        << "  \"renderer\": \"" << escapeJson(rendererString()) << "\",\n"
+        << "  \"version\": \"" << escapeJson(versionString()) << "\",\n"
+        << "  \"width\": " << options.width << ",\n"
+        << "  \"height\": " << options.height << ",\n"
+        << "  \"frames\": " << options.frames << ",\n"
+        << "  \"warmupFrames\": " << options.warmupFrames << ",\n"
+        << "  \"timestep\": " << options.timestep << ",\n"
+        << "  \"budget\": " << options.budget << ",\n"
+        << "  \"resolutionScale\": " << resolutionScale << ",\n"
+        << "  \"milliseconds\": {\n";
+    writeJsonSummary(out, "cpuFrame", cpu, false);
+    writeJsonSummary(out, "gpuFrame", gpu, true);
+    out << "  }\n}\n";
+  }
+  return (bool)out;
+}
+
+// Median time of runs calls to run, in seconds, after one untimed call that warms up the caches.
+// prepare is called before every call to run, outside the timing.
+template <typename Prepare, typename Run>
+static double medianSeconds(int runs, Prepare prepare, Run run) {
+  prepare();
+  run();
+  std::vector<double> samples;
+  for (int i = 0; i < runs; i++) {
+    prepare();
+    auto start = std::chrono::steady_clock::now();
+    run();
+    std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+    samples.push_back(time.count());
+  }
+  return BenchmarkReport::summarize(samples).p50;
+}
+
+template <typename Run>
+static double medianSeconds(int runs, Run run) {
+  return medianSeconds(runs, []() {}, run);
+}
+
+void runJobScalingBenchmark(size_t entityCount) {
+  // a square field of unit spheres, about a quarter of it in front of the camera
+  EntityStore scene;
+  size_t side = (size_t)std::ceil(std::sqrt((double)entityCount));
+  for (size_t i = 0; i < entityCount; i++) {
+    Entity entity = scene.create(TransformComponent | BoundsComponent);
+    scene.setTransform(entity, glm::vec3((float)(i % side) - side / 2.0f, 0.0f, (float)(i / side) - side / 2.0f));
+    scene.setBounds(entity, glm::vec3(0.0f), 0.87f);
+  }
+  glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 20.0f, 0.0f), glm::vec3(0.0f, 0.0f, -50.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+  Frustum frustum = extractFrustum(glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f) * view);
+  updateTransforms(scene);
+  updateBounds(scene);
+
+  // every cull gets a new camera version, so none of them reuses the last result
+  uint64_t cameraVersion = 0;
+  const int runs = 20;
+  unsigned int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+  double singleThreaded = 0.0;
+  std::cout << "Culling " << entityCount << " entities, median of " << runs << " runs" << std::endl;
+
+  for (unsigned int threads = 1; threads <= hardwareThreads; threads++) {
+    jobs.start(threads - 1);
+    double median = medianSeconds(runs, [&]() { cullBounds(scene, frustum, ++cameraVersion); }) * 1000.0;
+    if (threads == 1)
+      singleThreaded = median;
+
+    char line[128];
+    snprintf(line, sizeof(line), "  %2u threads: %8.3f ms  speed-up %5.2fx  efficiency %3.0f%%", threads,
+             median, singleThreaded / median, singleThreaded / median / threads * 100.0);
+    std::cout << line << std::endl;
+  }
+  jobs.stop();
+}
+
+void runCullingBenchmark(size_t objectCount) {
+  // objects scattered through a cube around a camera looking down -z, about a tenth of them visible
+  std::mt19937 random(1);
+  std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+  std::uniform_real_distribution<float> size(0.1f, 2.0f);
+  std::vector<float> x(objectCount), y(objectCount), z(objectCount), radius(objectCount);
+  std::vector<float> maxX(objectCount), maxY(objectCount), maxZ(objectCount);
+  for (size_t i = 0; i < objectCount; i++) {
+    x[i] = position(random);
+    y[i] = position(random);
+    z[i] = position(random);
+    radius[i] = size(random);
+    maxX[i] = x[i] + 2.0f * radius[i];
+    maxY[i] = y[i] + 2.0f * radius[i];
+    maxZ[i] = z[i] + 2.0f * radius[i];
+  }
+  glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+  Frustum frustum = extractFrustum(glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f) * view);
+  std::vector<uint32_t> visible(objectCount);
+
+  const int runs = 20;
+  std::cout << "Frustum tests over " << objectCount << " objects, median of " << runs << " runs" << std::endl;
+  auto measure = [&](const char *name, auto cull) {
+    size_t found = 0;
+    double median = medianSeconds(runs, [&]() { found = cull(); });
+    char line[128];
+    snprintf(line, sizeof(line), "  %-16s %8.1f M tests/s  (%zu visible)", name,
+             objectCount / median / 1e6, found);
+    std::cout << line << std::endl;
+  };
+
+  measure("spheres", [&]() {
+    return cullSpheres(frustum, x.data(), y.data(), z.data(), radius.data(), objectCount, visible.data());
+  });
+  measure("spheres scalar", [&]() {
+    return cullSpheresScalar(frustum, x.data(), y.data(), z.data(), radius.data(), objectCount, visible.data());
+  });
+  measure("boxes", [&]() {
+    return cullBoxes(frustum, x.data(), y.data(), z.data(), maxX.data(), maxY.data(), maxZ.data(), objectCount,
+                     visible.data());
+  });
+  measure("boxes scalar", [&]() {
+    return cullBoxesScalar(frustum, x.data(), y.data(), z.data(), maxX.data(), maxY.data(), maxZ.data(),
+                           objectCount, visible.data());
+  });
+}
+
+void runTransformBenchmark(size_t instanceCount) {
+  // one batch of bare translations, which takes the shortcut in the SIMD kernels, and one where
+  // every instance is rotated and scaled
+  std::mt19937 random(1);
+  std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+  std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+  std::uniform_real_distribution<float> size(0.5f, 2.0f);
+  TransformBatch translated, rotated;
+  for (size_t i = 0; i < instanceCount; i++) {
+    glm::vec3 translation(position(random), position(random), position(random));
+    translated.add(translation);
+    glm::quat rotation = glm::normalize(glm::quat(unit(random), unit(random), unit(random), unit(random)));
+    rotated.add(translation, rotation, glm::vec3(size(random), size(random), size(random)));
+  }
+  std::vector<InstanceData> instances(instanceCount);
+
+  const int runs = 20;
+  std::cout << "Model and normal matrices of " << instanceCount << " instances, median of " << runs
+            << " runs, " << TransformBatch::kernelName() << " kernel" << std::endl;
+  auto measure = [&](const char *name, auto compute) {
+    double median = medianSeconds(runs, compute);
+    char line[128];
+    snprintf(line, sizeof(line), "  %-20s %8.1f M matrices/s", name, instanceCount / median / 1e6);
+    std::cout << line << std::endl;
+  };
+
+  // the per-instance glm code the batch replaced: compose the TRS and invert it for the normal matrix
+  auto baseline = [&](const TransformBatch &batch) {
+    for (size_t i = 0; i < batch.size(); i++) {
+      glm::mat4 model = glm::translate(glm::mat4(1.0f), batch.translation(i)) * glm::mat4_cast(batch.rotation(i)) *
+                        glm::scale(glm::mat4(1.0f), batch.scale(i));
+      instances[i].model = model;
+      instances[i].normalMatrix = glm::mat3(glm::transpose(glm::inverse(model)));
+    }
+  };
+
+  measure("translated", [&]() { translated.computeInstances(instances.data()); });
+  measure("translated scalar", [&]() { translated.computeInstancesScalar(instances.data()); });
+  measure("translated glm", [&]() { baseline(translated); });
+  measure("rotated", [&]() { rotated.computeInstances(instances.data()); });
+  measure("rotated scalar", [&]() { rotated.computeInstancesScalar(instances.data()); });
+  measure("rotated glm", [&]() { baseline(rotated); });
+}
+
+void runSortBenchmark(size_t keyCount) {
+  // random keys need every pass; draw keys follow the opaque CommandBuffer layout with a handful of
+  // programs, materials and vertex arrays at random depths
+  std::mt19937_64 random(1);
+  std::vector<uint64_t> randomKeys(keyCount), drawKeys(keyCount);
+  for (size_t i = 0; i < keyCount; i++) {
+    randomKeys[i] = random();
+    drawKeys[i] = (random() % 8) << 52 | (random() % 64) << 38 | (random() % 64) << 24 | (random() & 0xFFFFFF);
+  }
+  std::vector<uint64_t> keys(keyCount), keyScratch(keyCount);
+  std::vector<uint32_t> values(keyCount), valueScratch(keyCount);
+
+  const int runs = 20;
+  std::cout << "Sorting " << keyCount << " keys with values, median of " << runs << " runs" << std::endl;
+  auto measure = [&](const char *name, const std::vector<uint64_t> &input, auto sort) {
+    // every run sorts the same unsorted keys
+    auto reset = [&]() {
+      keys = input;
+      for (size_t i = 0; i < keyCount; i++)
+        values[i] = (uint32_t)i;
+    };
+    double median = medianSeconds(runs, reset, sort);
+    char line[128];
+    snprintf(line, sizeof(line), "  %-20s %8.1f M keys/s%s", name, keyCount / median / 1e6,
+             std::is_sorted(keys.begin(), keys.end()) ? "" : "  NOT SORTED");
+    std::cout << line << std::endl;
+  };
+
+  auto radix = [&]() {
+    radixSortKeys(keys.data(), values.data(), keyCount, keyScratch.data(), valueScratch.data());
+  };
+  // the reference sorts the keys alone, so it does less work than the radix sort
+  auto reference = [&]() { std::sort(keys.begin(), keys.end()); };
+  measure("random radix", randomKeys, radix);
+  measure("random std::sort", randomKeys, reference);
+  measure("draw keys radix", drawKeys, radix);
+  measure("draw keys std::sort", drawKeys, reference);
+}
+
+void runUniformBenchmark(const char *vertexPath, const char *fragmentPath, size_t lookupCount) {
+  // a surfaceless EGL context where there is one, otherwise a hidden window
+  HeadlessContext context;
+  GLFWwindow *window = NULL;
+  GLADloadfunc loadFunction = HeadlessContext::getProcAddress;
+  bool current = context.create();
+  if (!current) {
+    glfwInit();
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    window = glfwCreateWindow(64, 64, "Uniform benchmark", NULL, NULL);
+    if (window) {
+      glfwMakeContextCurrent(window);
+      current = true;
+    }
+    loadFunction = (GLADloadfunc)glfwGetProcAddress;
+  }
+  if (!current || !gladLoadGL(loadFunction)) {
+    std::cout << "ERROR::BENCHMARK::NO_CONTEXT" << std::endl;
+    glfwTerminate();
+    return;
+  }
+  loadGLExtensions(loadFunction);
+
+  // the lit permutation with every feature on has the most uniforms
+  Shader shader(vertexPath, fragmentPath,
+                ShaderDefines()
+                    .set("NUM_POINT_LIGHTS", 4)
+                    .set("HAS_DIR_LIGHT", 1)
+                    .set("HAS_SPOT_LIGHT", 1)
+                    .set("HAS_SPECULAR_MAP", 1),
+                nullptr, Shader::Deferred{});
+  shader.wait();
+  UniformTable table;
+  table.build(shader.ID);
+
+  // look up every uniform with a location by the name the driver reports, plus one the program lacks
+  std::vector<std::string> names;
+  int count = 0, maxLength = 0;
+  glGetProgramiv(shader.ID, GL_ACTIVE_UNIFORMS, &count);
+  glGetProgramiv(shader.ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+  std::vector<char> buffer(maxLength + 1);
+  for (int i = 0; i < count; i++) {
+    int length = 0, size = 0;
+    GLenum type;
+    glGetActiveUniform(shader.ID, i, maxLength + 1, &length, &size, &type, buffer.data());
+    // members of uniform blocks have no location
+    if (glGetUniformLocation(shader.ID, buffer.data()) >= 0)
+      names.emplace_back(buffer.data(), length);
+  }
+  names.push_back("missing");
+  std::vector<uint64_t> hashes;
+  std::unordered_map<std::string_view, int> map;
+  for (const std::string &name : names) {
+    hashes.push_back(hashUniformName(name));
+    map.emplace(name, table.find(name));
+  }
+
+  size_t rounds = std::max<size_t>(1, lookupCount / names.size());
+  const int runs = 10;
+  std::cout << "Uniform lookups over " << names.size() << " names, " << rounds * names.size()
+            << " per run, median of " << runs << " runs" << std::endl;
+  auto measure = [&](const char *name, auto find) {
+    size_t found = 0;
+    double median = medianSeconds(runs, [&]() {
+      found = 0;
+      for (size_t round = 0; round < rounds; round++)
+        for (size_t i = 0; i < names.size(); i++)
+          found += find(i) >= 0;
+    });
+    char line[128];
+    snprintf(line, sizeof(line), "  %-22s %8.1f M lookups/s  (%zu found)", name,
+             rounds * names.size() / median / 1e6, found / rounds);
+    std::cout << line << std::endl;
+  };
+
+  measure("table, hashed name", [&](size_t i) { return table.find(hashes[i]); });
+  measure("table, by name", [&](size_t i) { return table.find(names[i]); });
+  measure("std::unordered_map", [&](size_t i) { return map.find(names[i])->second; });
+  measure("glGetUniformLocation", [&](size_t i) { return glGetUniformLocation(shader.ID, names[i].c_str()); });
+
+  shader.deleteShader();
+  if (window) {
+    glfwDestroyWindow(window);
+    glfwTerminate();
+  } else {
+    context.destroy();
+  }
+}
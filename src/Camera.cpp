@@ -1,5 +1,3 @@
-#include <glad/gl.h>
-#include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -7,67 +5,148 @@
 #include "Camera.h"
 
 Camera::Camera(glm::vec3 position, glm::vec3 up, float yaw, float pitch,
-				   float lastX, float lastY) 
-	: CameraFront(glm::vec3(0.0f, 0.0f, -1.0f)), _movementSpeed(2.5f), _mouseSensitivity(0.1f), _zoom(45.0f) {
-	CameraPos = position;
-	WorldUp = up;
+				   float lastX, float lastY)
+	: _front(glm::vec3(0.0f, 0.0f, -1.0f)), _movementSpeed(2.5f), _mouseSensitivity(0.1f), _zoom(45.0f) {
+	_position = position;
+	_worldUp = up;
 	_yaw = yaw;
 	_pitch = pitch;
 	_lastX = lastX;
 	_lastY = lastY;
 
-	glm::vec3 direction = glm::vec3(
-		cos(glm::radians(_yaw)) * cos(glm::radians(_pitch)),
-		sin(glm::radians(_pitch)),
-		sin(glm::radians(_yaw)) * cos(glm::radians(_pitch))
-	);
-	CameraFront = glm::normalize(direction);
-	CameraRight = glm::normalize(glm::cross(CameraFront, WorldUp));
-	CameraUp = glm::normalize(glm::cross(CameraRight, CameraFront));
+	updateVectors();
 }
 
-void Camera::mouseCallback(GLFWwindow* window, double xpos, double ypos) {
-	if (_firstMouse) {
-		_lastX = xpos;
-		_lastY = ypos;
-		_firstMouse = false;
-	}
+void Camera::processEvents(InputQueue& events, double until) {
+	float xoffset = 0.0f;
+	float yoffset = 0.0f;
+	float scroll = 0.0f;
 
-	float xoffset = xpos - _lastX;
-	float yoffset = _lastY - ypos;							// reversed since y-coordinates go from bottom to top
-	_lastX = xpos;
-	_lastY = ypos;
+	InputEvent event;
+	while (events.pop(event, until)) {
+		if (event.type == InputEvent::Type::Scroll) {
+			scroll += (float) event.y;
+			continue;
+		}
+
+		// positions are absolute, so a coalesced event only merges two movements
+		if (_firstMouse) {
+			_lastX = event.x;
+			_lastY = event.y;
+			_firstMouse = false;
+		}
+		xoffset += event.x - _lastX;
+		yoffset += _lastY - event.y;						// reversed since y-coordinates go from bottom to top
+		_lastX = event.x;
+		_lastY = event.y;
+	}
 
 	xoffset *= _mouseSensitivity;
 	yoffset *= _mouseSensitivity;
-	
-	_yaw += xoffset;
-	_pitch += yoffset;
+
+	float yaw = _yaw + xoffset;
+	float pitch = _pitch + yoffset;
 
 	// constraint pitch
-	if (_pitch > 89.0f)
-		_pitch = 89.0f;
-	if (_pitch < -89.0f)
-		_pitch = -89.0f;
+	if (pitch > 89.0f)
+		pitch = 89.0f;
+	if (pitch < -89.0f)
+		pitch = -89.0f;
+
+	if (yaw != _yaw || pitch != _pitch) {
+		_yaw = yaw;
+		_pitch = pitch;
+		updateVectors();
+		invalidate(VIEW);
+	}
+
+	float zoom = _zoom - scroll;
+	if (zoom < 1.0f)
+		zoom = 1.0f;
+	if (zoom > 45.0f)
+		zoom = 45.0f;
+
+	if (zoom != _zoom) {
+		_zoom = zoom;
+		invalidate(PROJECTION);
+	}
+}
+
+void Camera::setPosition(const glm::vec3& position) {
+	if (position == _position)
+		return;
+	_position = position;
+	invalidate(VIEW);
+}
+
+void Camera::setAspect(float aspect) {
+	if (aspect == _aspect)
+		return;
+	_aspect = aspect;
+	invalidate(PROJECTION);
+}
+
+void Camera::setClipPlanes(float nearPlane, float farPlane) {
+	if (nearPlane == _nearPlane && farPlane == _farPlane)
+		return;
+	_nearPlane = nearPlane;
+	_farPlane = farPlane;
+	invalidate(PROJECTION);
+}
 
+const glm::mat4& Camera::getView() const {
+	if (_dirty & VIEW) {
+		_view = glm::lookAt(_position, _position + _front, _up);
+		_dirty &= ~VIEW;
+	}
+	return _view;
+}
+
+const glm::mat4& Camera::getProjection() const {
+	if (_dirty & PROJECTION) {
+		_projection = glm::perspective(glm::radians(_zoom), _aspect, _nearPlane, _farPlane);
+		_dirty &= ~PROJECTION;
+	}
+	return _projection;
+}
+
+const glm::mat4& Camera::getViewProjection() const {
+	if (_dirty & VIEW_PROJECTION) {
+		_viewProjection = getProjection() * getView();
+		_dirty &= ~VIEW_PROJECTION;
+	}
+	return _viewProjection;
+}
+
+const glm::mat4& Camera::getInverseViewProjection() const {
+	if (_dirty & INVERSE_VIEW_PROJECTION) {
+		_inverseViewProjection = glm::inverse(getViewProjection());
+		_dirty &= ~INVERSE_VIEW_PROJECTION;
+	}
+	return _inverseViewProjection;
+}
+
+const Frustum& Camera::getFrustum() const {
+	if (_dirty & FRUSTUM) {
+		_frustum = extractFrustum(getViewProjection());
+		_dirty &= ~FRUSTUM;
+	}
+	return _frustum;
+}
+
+void Camera::invalidate(unsigned int changed) {
+	// everything past the view and projection combines both
+	_dirty |= changed | VIEW_PROJECTION | INVERSE_VIEW_PROJECTION | FRUSTUM;
+	_version++;
+}
+
+void Camera::updateVectors() {
 	glm::vec3 direction = glm::vec3(
 		cos(glm::radians(_yaw)) * cos(glm::radians(_pitch)),
 		sin(glm::radians(_pitch)),
 		sin(glm::radians(_yaw)) * cos(glm::radians(_pitch))
 	);
-	CameraFront = glm::normalize(direction);
-	CameraRight = glm::normalize(glm::cross(CameraFront, WorldUp));
-	CameraUp = glm::normalize(glm::cross(CameraRight, CameraFront));
-}
-
-void Camera::scrollCallback(GLFWwindow* window, double xoffset, double yoffset) {
-	_zoom -= (float) yoffset;
-	if (_zoom < 1.0f)
-		_zoom = 1.0f;
-	if (_zoom > 45.0f)
-		_zoom = 45.0f; 
-}
-
-glm::mat4 Camera::calculateLookAt() {
-	return glm::lookAt(CameraPos, CameraPos + CameraFront, CameraUp);
+	_front = glm::normalize(direction);
+	_right = glm::normalize(glm::cross(_front, _worldUp));
+	_up = glm::normalize(glm::cross(_right, _front));
 }
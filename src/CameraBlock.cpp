@@ -0,0 +1,34 @@
+#include "CameraBlock.h"
+
+void setCameraBlock(CameraBlock& block, const glm::mat4& view, const glm::mat4& projection,
+					const glm::vec3& position) {
+	block.view = view;
+	block.projection = projection;
+	block.viewProjection = projection * view;
+	block.position = glm::vec4(position, 1.0f);
+}
+
+CameraBuffer::CameraBuffer() {
+	glGenBuffers(1, &ID);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, ID);
+	glBufferData(GL_COPY_WRITE_BUFFER, sizeof(CameraBlock), NULL, GL_DYNAMIC_DRAW);
+	glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_BLOCK_BINDING, ID);
+}
+
+bool CameraBuffer::update(uint64_t version, const glm::mat4& view, const glm::mat4& projection,
+						  const glm::vec3& position) {
+	if (version == _version)
+		return false;
+	_version = version;
+
+	CameraBlock block;
+	setCameraBlock(block, view, projection, position);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, ID);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, 0, sizeof(CameraBlock), &block);
+	return true;
+}
+
+void CameraBuffer::deleteBuffer() {
+	glDeleteBuffers(1, &ID);
+	_version = 0;
+}
@@ -0,0 +1,176 @@
+#include <string.h>
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+#include "CommandBuffer.h"
+
+// Width of each field of a sort key, see CommandBuffer.h
+static const int PASS_BITS = 2;
+static const int PROGRAM_BITS = 10;
+static const int MATERIAL_BITS = 14;
+static const int VERTEX_ARRAY_BITS = 14;
+static const int DEPTH_BITS = 24;
+static const int STATE_BITS = PROGRAM_BITS + MATERIAL_BITS + VERTEX_ARRAY_BITS;
+static_assert(PASS_BITS + STATE_BITS + DEPTH_BITS == 64, "sort key fields must fill 64 bits");
+
+static uint64_t field(uint64_t value, int bits) {
+  return value & ((1ull << bits) - 1);
+}
+
+// FNV-1a over the bound texture IDs, in unit order, folded to the material field
+static uint32_t materialHash(const Mesh &mesh) {
+  uint64_t hash = 14695981039346656037ull;
+  for (const Texture &texture : mesh.textures) {
+    hash ^= texture.id;
+    hash *= 1099511628211ull;
+  }
+  hash ^= hash >> 32;
+  hash ^= hash >> MATERIAL_BITS;
+  return (uint32_t)field(hash, MATERIAL_BITS);
+}
+
+CommandBuffer::CommandBuffer(float nearPlane, float farPlane)
+    : _nearPlane(nearPlane), _farPlane(farPlane) {}
+
+void CommandBuffer::submit(RenderPass pass, Shader &shader, Mesh &mesh,
+                           const glm::mat4 &model, float depth) {
+  begin(sortKey(pass, shader, mesh, depth));
+  useProgram(shader);
+  setUniform(shader, shader.getUniformLocation(_modelUniform), model);
+  drawMesh(shader, mesh, 0);
+}
+
+void CommandBuffer::submitInstanced(RenderPass pass, Shader &shader, Mesh &mesh,
+                                    size_t instanceCount, float depth) {
+  if (instanceCount == 0)
+    return;
+  begin(sortKey(pass, shader, mesh, depth));
+  useProgram(shader);
+  drawMesh(shader, mesh, instanceCount);
+}
+
+void CommandBuffer::submitIndirect(RenderPass pass, Shader &shader, Mesh &mesh,
+                                   IndirectDrawList &list, float depth) {
+  if (list.size() == 0)
+    return;
+  begin(sortKey(pass, shader, mesh, depth));
+  useProgram(shader);
+  drawIndirect(shader, mesh, list);
+}
+
+void CommandBuffer::begin(uint64_t key) {
+  _keys.push_back(key);
+  _packets.push_back((uint32_t)_data.size());
+}
+
+void CommandBuffer::useProgram(Shader &shader) {
+  record(CommandType::UseProgram, UseProgramCommand{&shader});
+}
+
+void CommandBuffer::setUniform(Shader &shader, int location, const glm::mat4 &value) {
+  if (location < 0)
+    return;
+  record(CommandType::SetUniformMat4, SetUniformMat4Command{&shader, location, value});
+}
+
+void CommandBuffer::drawMesh(Shader &shader, Mesh &mesh, size_t instanceCount) {
+  record(CommandType::DrawMesh, DrawMeshCommand{&shader, &mesh, (uint32_t)instanceCount});
+}
+
+void CommandBuffer::drawIndirect(Shader &shader, Mesh &mesh, IndirectDrawList &list) {
+  record(CommandType::DrawIndirect, DrawIndirectCommand{&shader, &mesh, &list});
+}
+
+template <typename T>
+void CommandBuffer::record(CommandType type, const T &command) {
+  static_assert(std::is_trivially_copyable<T>::value, "commands must be plain data");
+  CommandHeader header{type, (uint16_t)sizeof(T)};
+  size_t offset = _data.size();
+  _data.resize(offset + sizeof(header) + sizeof(T));
+  memcpy(_data.data() + offset, &header, sizeof(header));
+  memcpy(_data.data() + offset + sizeof(header), &command, sizeof(T));
+}
+
+uint64_t CommandBuffer::sortKey(RenderPass pass, const Shader &shader, const Mesh &mesh,
+                                float depth) const {
+  uint32_t quantizedDepth = quantizeDepth(depth);
+  uint64_t state = (field(shader.ID, PROGRAM_BITS) << (MATERIAL_BITS + VERTEX_ARRAY_BITS)) |
+                   ((uint64_t)materialHash(mesh) << VERTEX_ARRAY_BITS) |
+                   field(mesh.getVAO(), VERTEX_ARRAY_BITS);
+
+  uint64_t key = (uint64_t)pass << (64 - PASS_BITS);
+  if (pass == RenderPass::Opaque) {
+    // group by state, then front to back for early depth rejection
+    key |= (state << DEPTH_BITS) | quantizedDepth;
+  } else {
+    // blending needs back to front, state only breaks ties
+    uint64_t inverted = field(~quantizedDepth, DEPTH_BITS);
+    key |= (inverted << STATE_BITS) | state;
+  }
+  return key;
+}
+
+SortKeyState CommandBuffer::keyState(uint64_t key) {
+  bool opaque = (key >> (64 - PASS_BITS)) == (uint64_t)RenderPass::Opaque;
+  uint64_t state = field(opaque ? key >> DEPTH_BITS : key, STATE_BITS);
+  return SortKeyState{(uint32_t)(state >> (MATERIAL_BITS + VERTEX_ARRAY_BITS)),
+                      (uint32_t)field(state >> VERTEX_ARRAY_BITS, MATERIAL_BITS),
+                      (uint32_t)field(state, VERTEX_ARRAY_BITS)};
+}
+
+uint32_t CommandBuffer::quantizeDepth(float depth) const {
+  float clamped = std::clamp(depth, _nearPlane, _farPlane);
+  float t = std::log(clamped / _nearPlane) / std::log(_farPlane / _nearPlane);
+  return (uint32_t)(t * (float)((1u << DEPTH_BITS) - 1));
+}
+
+void CommandBuffer::clear() {
+  _keys.clear();
+  _packets.clear();
+  _data.clear();
+}
+
+void CommandBuffer::replay(size_t packet) const {
+  const unsigned char *cursor = _data.data() + _packets[packet];
+  const unsigned char *end = _data.data() + (packet + 1 < _packets.size() ? _packets[packet + 1] : _data.size());
+
+  // commands are copied out since the byte stream keeps no alignment
+  while (cursor < end) {
+    CommandHeader header;
+    memcpy(&header, cursor, sizeof(header));
+    const unsigned char *payload = cursor + sizeof(header);
+
+    switch (header.type) {
+    case CommandType::UseProgram: {
+      UseProgramCommand command;
+      memcpy(&command, payload, sizeof(command));
+      command.shader->use();
+      break;
+    }
+    case CommandType::SetUniformMat4: {
+      SetUniformMat4Command command;
+      memcpy(&command, payload, sizeof(command));
+      command.shader->setUniform(command.location, command.value);
+      break;
+    }
+    case CommandType::DrawMesh: {
+      DrawMeshCommand command;
+      memcpy(&command, payload, sizeof(command));
+      if (command.instanceCount == 0)
+        command.mesh->Draw(*command.shader);
+      else
+        command.mesh->DrawInstanced(*command.shader, command.instanceCount);
+      break;
+    }
+    case CommandType::DrawIndirect: {
+      DrawIndirectCommand command;
+      memcpy(&command, payload, sizeof(command));
+      command.list->draw(*command.shader, *command.mesh);
+      break;
+    }
+    }
+    cursor = payload + header.size;
+  }
+}
@@ -0,0 +1,63 @@
+#include <iostream>
+#include <string>
+
+#include "CameraBlock.h"
+#include "ComputeShader.h"
+#include "GLExtensions.h"
+#include "GLState.h"
+
+ComputeShader::ComputeShader(const char *computePath,
+                             const ShaderDefines &defines)
+    : ID(0) {
+  std::string computeCode;
+  preprocessShader(computePath, defines, computeCode);
+  const char *computeSource = computeCode.c_str();
+
+  int success;
+  char infoLog[512];
+
+  unsigned int compute = glCreateShader(GL_COMPUTE_SHADER);
+  glShaderSource(compute, 1, &computeSource, NULL);
+  glCompileShader(compute);
+  glGetShaderiv(compute, GL_COMPILE_STATUS, &success);
+  if (!success) {
+    glGetShaderInfoLog(compute, 512, NULL, infoLog);
+    std::cout << "ERROR::SHADER::COMPUTE::COMPILATION_FAILED\n"
+              << infoLog << std::endl;
+    glDeleteShader(compute);
+    return;
+  }
+
+  unsigned int program = glCreateProgram();
+  glAttachShader(program, compute);
+  glLinkProgram(program);
+  glDeleteShader(compute);
+  glGetProgramiv(program, GL_LINK_STATUS, &success);
+  if (!success) {
+    glGetProgramInfoLog(program, 512, NULL, infoLog);
+    std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
+              << infoLog << std::endl;
+    glDeleteProgram(program);
+    return;
+  }
+  ID = program;
+
+  // same block binding as the graphics programs, see Shader::bindUniformBlocks
+  unsigned int camera = glGetUniformBlockIndex(ID, "CameraBlock");
+  if (camera != GL_INVALID_INDEX)
+    glUniformBlockBinding(ID, camera, CAMERA_BLOCK_BINDING);
+}
+
+void ComputeShader::use() {
+  glState.useProgram(ID);
+}
+
+void ComputeShader::dispatch(unsigned int invocations, unsigned int groupSize) {
+  glDispatchCompute((invocations + groupSize - 1) / groupSize, 1, 1);
+}
+
+void ComputeShader::deleteShader() {
+  glState.forgetProgram(ID);
+  glDeleteProgram(ID);
+  ID = 0;
+}
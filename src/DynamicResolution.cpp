@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <cmath>
+
+#include "DynamicResolution.h"
+#include "GLState.h"
+
+// Scales are rounded to this step so the render size does not creep by a pixel every frame
+static const float SCALE_STEP = 1.0f / 32.0f;
+
+// GPU timer results arrive a few frames late; after a change these samples still show the old scale
+static const unsigned int SETTLE_SAMPLES = 5;
+
+// Samples averaged before the scale may rise again
+static const unsigned int RAISE_SAMPLES = 30;
+
+// Fraction of the budget aimed for, and the fraction frames must stay under before the scale rises
+static const double TARGET_FRACTION = 0.9;
+static const double RAISE_FRACTION = 0.75;
+
+// Largest rise of the scale in one step; drops are not limited
+static const float MAX_RAISE = 0.125f;
+
+DynamicResolution::DynamicResolution(const char *vertexPath, const char *fragmentPath, int width,
+                                     int height, double budgetMilliseconds, float minScale,
+                                     float maxScale)
+    : _scene((int)std::ceil(width * maxScale), (int)std::ceil(height * maxScale)),
+      _shader(vertexPath, fragmentPath), _outputWidth(width), _outputHeight(height),
+      _budget(budgetMilliseconds), _minScale(minScale), _maxScale(maxScale), _scale(maxScale) {
+  // the upscale triangle is generated from gl_VertexID, but core profile still needs a vertex array
+  glGenVertexArrays(1, &_vao);
+}
+
+void DynamicResolution::resize(int width, int height) {
+  if (width <= 0 || height <= 0 || (width == _outputWidth && height == _outputHeight))
+    return;
+  _outputWidth = width;
+  _outputHeight = height;
+  _scene.resize((int)std::ceil(width * _maxScale), (int)std::ceil(height * _maxScale));
+}
+
+int DynamicResolution::renderWidth() const {
+  return std::clamp((int)std::lround(_outputWidth * _scale), 1, _scene.width());
+}
+
+int DynamicResolution::renderHeight() const {
+  return std::clamp((int)std::lround(_outputHeight * _scale), 1, _scene.height());
+}
+
+void DynamicResolution::update(const std::vector<double> &milliseconds) {
+  if (_budget <= 0.0)
+    return;
+
+  for (double sample : milliseconds) {
+    if (_settle > 0) {
+      _settle--;
+      continue;
+    }
+    _smoothed = _samples == 0 ? sample : _smoothed + 0.25 * (sample - _smoothed);
+    _samples++;
+
+    // GPU time grows with the pixel count, the square of the scale
+    if (_smoothed > _budget || sample > _budget * 1.5) {
+      double worst = std::max(_smoothed, sample);
+      setScale(_scale * (float)std::sqrt(_budget * TARGET_FRACTION / worst));
+    } else if (_samples >= RAISE_SAMPLES && _smoothed < _budget * RAISE_FRACTION) {
+      float raised = _scale * (float)std::sqrt(_budget * TARGET_FRACTION / _smoothed);
+      setScale(std::min(raised, _scale + MAX_RAISE));
+    }
+  }
+}
+
+void DynamicResolution::setScale(float scale) {
+  scale = std::round(scale / SCALE_STEP) * SCALE_STEP;
+  scale = std::clamp(scale, _minScale, _maxScale);
+  if (scale == _scale)
+    return;
+
+  _scale = scale;
+  _samples = 0;
+  _settle = SETTLE_SAMPLES;
+}
+
+void DynamicResolution::beginScene() {
+  glBindFramebuffer(GL_FRAMEBUFFER, _scene.ID);
+  glViewport(0, 0, renderWidth(), renderHeight());
+}
+
+void DynamicResolution::present(unsigned int framebuffer) {
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  glViewport(0, 0, _outputWidth, _outputHeight);
+  glDisable(GL_DEPTH_TEST);
+
+  _shader.use();
+  glState.bindTexture(0, GL_TEXTURE_2D, _scene.ColorTexture);
+  _shader.set(_sceneTextureUniform, 0);
+  _shader.set(_uvScaleUniform, glm::vec2((float)renderWidth() / (float)_scene.width(),
+                                         (float)renderHeight() / (float)_scene.height()));
+  _shader.set(_sharpnessUniform, _scale < 1.0f ? _sharpness : 0.0f);
+
+  glState.bindVertexArray(_vao);
+  glDrawArrays(GL_TRIANGLES, 0, 3);
+  glEnable(GL_DEPTH_TEST);
+}
+
+void DynamicResolution::deleteResources() {
+  _scene.deleteFramebuffer();
+  _shader.deleteShader();
+  glState.forgetVertexArray(_vao);
+  glDeleteVertexArrays(1, &_vao);
+}
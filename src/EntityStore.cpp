@@ -0,0 +1,229 @@
+#include <iostream>
+
+#include "EntityStore.h"
+
+static const uint32_t GENERATION_SHIFT = 24;
+
+static Entity makeEntity(uint32_t index, uint32_t generation) {
+  return index | (generation << GENERATION_SHIFT);
+}
+
+// Append a row with default components for every column the archetype has
+static void pushRow(Archetype &archetype, Entity entity) {
+  archetype.entities.push_back(entity);
+  if (archetype.has(TransformComponent)) {
+    archetype.transforms.add(glm::vec3(0.0f));
+    archetype.instances.push_back(InstanceData{glm::mat4(1.0f), glm::mat3(1.0f)});
+    archetype.previousTransforms.clear();                   // no previous step to blend from until the next one
+  }
+  if (archetype.has(BoundsComponent)) {
+    for (std::vector<float> *column :
+         {&archetype.localX, &archetype.localY, &archetype.localZ, &archetype.localRadius,
+          &archetype.worldX, &archetype.worldY, &archetype.worldZ, &archetype.worldRadius})
+      column->push_back(0.0f);
+    archetype.culled = false;                               // new rows count as visible until culled
+  }
+  if (archetype.has(RenderableComponent))
+    archetype.renderables.push_back(Renderable());
+  if (archetype.has(InstancedComponent))
+    archetype.instanced.push_back(Instanced());
+  if (archetype.has(PointLightComponent))
+    archetype.pointLights.push_back(PointLight());
+  if (archetype.has(OrbitComponent))
+    archetype.orbits.push_back(Orbit());
+}
+
+// Copy the components two archetypes share from one row to another
+static void copyRow(Archetype &to, size_t toRow, const Archetype &from, size_t fromRow) {
+  ComponentMask shared = to.mask & from.mask;
+  if (shared & TransformComponent) {
+    to.transforms.setTranslation(toRow, from.transforms.translation(fromRow));
+    to.transforms.setRotation(toRow, from.transforms.rotation(fromRow));
+    to.transforms.setScale(toRow, from.transforms.scale(fromRow));
+    to.instances[toRow] = from.instances[fromRow];
+  }
+  if (shared & BoundsComponent) {
+    to.localX[toRow] = from.localX[fromRow];
+    to.localY[toRow] = from.localY[fromRow];
+    to.localZ[toRow] = from.localZ[fromRow];
+    to.localRadius[toRow] = from.localRadius[fromRow];
+    to.worldX[toRow] = from.worldX[fromRow];
+    to.worldY[toRow] = from.worldY[fromRow];
+    to.worldZ[toRow] = from.worldZ[fromRow];
+    to.worldRadius[toRow] = from.worldRadius[fromRow];
+  }
+  if (shared & RenderableComponent)
+    to.renderables[toRow] = from.renderables[fromRow];
+  if (shared & InstancedComponent)
+    to.instanced[toRow] = from.instanced[fromRow];
+  if (shared & PointLightComponent)
+    to.pointLights[toRow] = from.pointLights[fromRow];
+  if (shared & OrbitComponent)
+    to.orbits[toRow] = from.orbits[fromRow];
+}
+
+// Move the last element of a column into a row and drop the last element
+template <typename T>
+static void swapRemove(std::vector<T> &column, size_t row) {
+  if (column.empty())
+    return;
+  column[row] = column.back();
+  column.pop_back();
+}
+
+EntityStore::EntityStore() {
+  // archetype 0 holds entities without components
+  _archetypes.push_back(std::make_unique<Archetype>());
+}
+
+uint32_t EntityStore::findArchetype(ComponentMask components) {
+  for (uint32_t i = 0; i < _archetypes.size(); i++) {
+    if (_archetypes[i]->mask == components)
+      return i;
+  }
+  _archetypes.push_back(std::make_unique<Archetype>());
+  _archetypes.back()->mask = components;
+  return (uint32_t)_archetypes.size() - 1;
+}
+
+Entity EntityStore::create(ComponentMask components) {
+  uint32_t index;
+  if (!_freeSlots.empty()) {
+    index = _freeSlots.back();
+    _freeSlots.pop_back();
+  } else if (_slots.size() < MAX_ENTITIES) {
+    index = (uint32_t)_slots.size();
+    _slots.push_back(Slot());
+  } else {
+    std::cout << "ERROR::ENTITY_STORE::TOO_MANY_ENTITIES" << std::endl;
+    return NULL_ENTITY;
+  }
+
+  Slot &entry = _slots[index];
+  Entity entity = makeEntity(index, entry.generation);
+  entry.archetype = findArchetype(components);
+  entry.row = (uint32_t)_archetypes[entry.archetype]->size();
+  entry.alive = true;
+  pushRow(*_archetypes[entry.archetype], entity);
+  _alive++;
+  return entity;
+}
+
+bool EntityStore::isAlive(Entity entity) const {
+  uint32_t index = entity & (MAX_ENTITIES - 1);
+  return entity != NULL_ENTITY && index < _slots.size() && _slots[index].alive &&
+         _slots[index].generation == entity >> GENERATION_SHIFT;
+}
+
+void EntityStore::destroy(Entity entity) {
+  if (!isAlive(entity))
+    return;
+
+  Slot &entry = slot(entity);
+  removeRow(entry.archetype, entry.row);
+  entry.alive = false;
+  entry.generation = (entry.generation + 1) & 0xFF;
+  _freeSlots.push_back(entity & (MAX_ENTITIES - 1));
+  _alive--;
+}
+
+ComponentMask EntityStore::components(Entity entity) const {
+  return _archetypes[slot(entity).archetype]->mask;
+}
+
+void EntityStore::addComponents(Entity entity, ComponentMask components) {
+  moveEntity(entity, this->components(entity) | components);
+}
+
+void EntityStore::removeComponents(Entity entity, ComponentMask components) {
+  moveEntity(entity, this->components(entity) & ~components);
+}
+
+void EntityStore::moveEntity(Entity entity, ComponentMask components) {
+  Slot &entry = slot(entity);
+  if (_archetypes[entry.archetype]->mask == components)
+    return;
+
+  uint32_t target = findArchetype(components);
+  Archetype &from = *_archetypes[entry.archetype];
+  Archetype &to = *_archetypes[target];
+  uint32_t row = (uint32_t)to.size();
+  pushRow(to, entity);
+  copyRow(to, row, from, entry.row);
+
+  removeRow(entry.archetype, entry.row);
+  entry.archetype = target;
+  entry.row = row;
+}
+
+void EntityStore::removeRow(uint32_t archetypeIndex, uint32_t row) {
+  Archetype &archetype = *_archetypes[archetypeIndex];
+
+  // the last row fills the hole, so its entity has to be told where it went
+  Entity moved = archetype.entities.back();
+  slot(moved).row = row;
+
+  swapRemove(archetype.entities, row);
+  if (archetype.has(TransformComponent)) {
+    archetype.transforms.remove(row);
+    archetype.previousTransforms.clear();
+    swapRemove(archetype.instances, row);
+  }
+  for (std::vector<float> *column :
+       {&archetype.localX, &archetype.localY, &archetype.localZ, &archetype.localRadius,
+        &archetype.worldX, &archetype.worldY, &archetype.worldZ, &archetype.worldRadius})
+    swapRemove(*column, row);
+  archetype.culled = false;
+  swapRemove(archetype.renderables, row);
+  swapRemove(archetype.instanced, row);
+  swapRemove(archetype.pointLights, row);
+  swapRemove(archetype.orbits, row);
+}
+
+void EntityStore::setTransform(Entity entity, const glm::vec3 &translation,
+                               const glm::quat &rotation, const glm::vec3 &scale) {
+  const Slot &entry = slot(entity);
+  TransformBatch &transforms = _archetypes[entry.archetype]->transforms;
+  transforms.setTranslation(entry.row, translation);
+  transforms.setRotation(entry.row, rotation);
+  transforms.setScale(entry.row, scale);
+}
+
+void EntityStore::setTranslation(Entity entity, const glm::vec3 &translation) {
+  const Slot &entry = slot(entity);
+  _archetypes[entry.archetype]->transforms.setTranslation(entry.row, translation);
+}
+
+glm::vec3 EntityStore::translation(Entity entity) const {
+  const Slot &entry = slot(entity);
+  return _archetypes[entry.archetype]->transforms.translation(entry.row);
+}
+
+void EntityStore::setBounds(Entity entity, const glm::vec3 &center, float radius) {
+  const Slot &entry = slot(entity);
+  Archetype &archetype = *_archetypes[entry.archetype];
+  archetype.localX[entry.row] = center.x;
+  archetype.localY[entry.row] = center.y;
+  archetype.localZ[entry.row] = center.z;
+  archetype.localRadius[entry.row] = radius;
+}
+
+Renderable &EntityStore::renderable(Entity entity) {
+  const Slot &entry = slot(entity);
+  return _archetypes[entry.archetype]->renderables[entry.row];
+}
+
+Instanced &EntityStore::instanced(Entity entity) {
+  const Slot &entry = slot(entity);
+  return _archetypes[entry.archetype]->instanced[entry.row];
+}
+
+PointLight &EntityStore::pointLight(Entity entity) {
+  const Slot &entry = slot(entity);
+  return _archetypes[entry.archetype]->pointLights[entry.row];
+}
+
+Orbit &EntityStore::orbit(Entity entity) {
+  const Slot &entry = slot(entity);
+  return _archetypes[entry.archetype]->orbits[entry.row];
+}
@@ -0,0 +1,22 @@
+#include "FixedTimestep.h"
+
+FixedTimestep::FixedTimestep(uint64_t ticksPerSecond, unsigned int stepsPerSecond, unsigned int maxSteps)
+    : _ticksPerSecond(ticksPerSecond), _stepsPerSecond(stepsPerSecond),
+      _maxAccumulated(ticksPerSecond * maxSteps) {}
+
+void FixedTimestep::accumulate(uint64_t frameTicks) {
+  _accumulator += frameTicks * _stepsPerSecond;
+  if (_accumulator > _maxAccumulated) {
+    // the simulation falls behind real time rather than spending ever longer catching up
+    _accumulator = _maxAccumulated;
+    _droppedFrames++;
+  }
+}
+
+bool FixedTimestep::step() {
+  if (_accumulator < _ticksPerSecond)
+    return false;
+  _accumulator -= _ticksPerSecond;
+  _steps++;
+  return true;
+}
@@ -0,0 +1,47 @@
+#include <iostream>
+
+#include "Framebuffer.h"
+#include "GLState.h"
+
+Framebuffer::Framebuffer(int width, int height) {
+  glGenFramebuffers(1, &ID);
+  glGenTextures(1, &ColorTexture);
+  glGenRenderbuffers(1, &_depthStencil);
+  resize(width, height);
+}
+
+void Framebuffer::resize(int width, int height) {
+  _width = width;
+  _height = height;
+
+  glState.bindTexture(0, GL_TEXTURE_2D, ColorTexture);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+  glBindRenderbuffer(GL_RENDERBUFFER, _depthStencil);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+
+  glBindFramebuffer(GL_FRAMEBUFFER, ID);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, ColorTexture, 0);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, _depthStencil);
+
+  _complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+  if (!_complete)
+    std::cout << "ERROR::FRAMEBUFFER::INCOMPLETE " << width << "x" << height << std::endl;
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void Framebuffer::bind() {
+  glBindFramebuffer(GL_FRAMEBUFFER, ID);
+  glViewport(0, 0, _width, _height);
+}
+
+void Framebuffer::deleteFramebuffer() {
+  glState.forgetTexture(ColorTexture);
+  glDeleteFramebuffers(1, &ID);
+  glDeleteTextures(1, &ColorTexture);
+  glDeleteRenderbuffers(1, &_depthStencil);
+}
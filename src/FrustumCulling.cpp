@@ -0,0 +1,281 @@
+#include <algorithm>
+
+#include "FrustumCulling.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#define FRUSTUM_CULLING_X86 1
+#include <immintrin.h>
+#endif
+
+Frustum extractFrustum(const glm::mat4 &viewProjection) {
+  glm::mat4 rows = glm::transpose(viewProjection);
+  Frustum frustum = {{rows[3] + rows[0], rows[3] - rows[0], rows[3] + rows[1],
+                      rows[3] - rows[1], rows[3] + rows[2], rows[3] - rows[2]}};
+  for (glm::vec4 &plane : frustum.planes)
+    plane /= glm::length(glm::vec3(plane));
+  return frustum;
+}
+
+// The SIMD kernels add in the same order as these and do not fuse multiplies, so every path
+// gives bit-identical results
+
+static inline bool sphereInside(const Frustum &frustum, float x, float y, float z, float radius) {
+  bool inside = true;
+  for (const glm::vec4 &plane : frustum.planes) {
+    float distance = plane.x * x + plane.y * y;
+    distance = distance + plane.z * z;
+    distance = distance + plane.w;
+    inside &= distance >= -radius;
+  }
+  return inside;
+}
+
+static inline bool boxInside(const Frustum &frustum, float minX, float minY, float minZ,
+                             float maxX, float maxY, float maxZ) {
+  bool inside = true;
+  for (const glm::vec4 &plane : frustum.planes) {
+    float distance = std::max(plane.x * minX, plane.x * maxX) + std::max(plane.y * minY, plane.y * maxY);
+    distance = distance + std::max(plane.z * minZ, plane.z * maxZ);
+    distance = distance + plane.w;
+    inside &= distance >= 0.0f;
+  }
+  return inside;
+}
+
+size_t cullSpheresScalar(const Frustum &frustum, const float *x, const float *y, const float *z,
+                         const float *radius, size_t count, uint32_t *visible, uint32_t firstIndex) {
+  size_t written = 0;
+  for (size_t i = 0; i < count; i++) {
+    visible[written] = firstIndex + (uint32_t)i;
+    written += sphereInside(frustum, x[i], y[i], z[i], radius[i]);
+  }
+  return written;
+}
+
+size_t cullBoxesScalar(const Frustum &frustum, const float *minX, const float *minY, const float *minZ,
+                       const float *maxX, const float *maxY, const float *maxZ, size_t count,
+                       uint32_t *visible, uint32_t firstIndex) {
+  size_t written = 0;
+  for (size_t i = 0; i < count; i++) {
+    visible[written] = firstIndex + (uint32_t)i;
+    written += boxInside(frustum, minX[i], minY[i], minZ[i], maxX[i], maxY[i], maxZ[i]);
+  }
+  return written;
+}
+
+#ifdef FRUSTUM_CULLING_X86
+
+// Positions of the set bits of a 4-bit mask, in ascending order, padded with zeros
+struct CompactTable4 {
+  uint8_t order[16][4];
+  uint8_t count[16];
+};
+
+static constexpr CompactTable4 makeCompactTable4() {
+  CompactTable4 table = {};
+  for (int mask = 0; mask < 16; mask++) {
+    int n = 0;
+    for (int bit = 0; bit < 4; bit++)
+      if (mask & (1 << bit))
+        table.order[mask][n++] = (uint8_t)bit;
+    table.count[mask] = (uint8_t)n;
+  }
+  return table;
+}
+
+// Same for an 8-bit mask, one byte per lane so a row widens straight into a permutation
+struct CompactTable8 {
+  uint64_t order[256];
+};
+
+static constexpr CompactTable8 makeCompactTable8() {
+  CompactTable8 table = {};
+  for (int mask = 0; mask < 256; mask++) {
+    int n = 0;
+    for (int bit = 0; bit < 8; bit++)
+      if (mask & (1 << bit))
+        table.order[mask] |= (uint64_t)bit << (8 * n++);
+  }
+  return table;
+}
+
+static constexpr CompactTable4 COMPACT4 = makeCompactTable4();
+static constexpr CompactTable8 COMPACT8 = makeCompactTable8();
+
+// Append the indices of the lanes set in a 4-lane mask; always stores four, so visible needs room
+// for four past the current count
+static inline size_t compact4(uint32_t *visible, size_t written, int mask, uint32_t base) {
+  const uint8_t *order = COMPACT4.order[mask];
+  visible[written + 0] = base + order[0];
+  visible[written + 1] = base + order[1];
+  visible[written + 2] = base + order[2];
+  visible[written + 3] = base + order[3];
+  return written + COMPACT4.count[mask];
+}
+
+// Four spheres per iteration with SSE, which every x86-64 CPU has
+static size_t cullSpheresSSE(const Frustum &frustum, const float *x, const float *y, const float *z,
+                             const float *radius, size_t count, uint32_t *visible, uint32_t firstIndex) {
+  __m128 planes[6][4];
+  for (int p = 0; p < 6; p++)
+    for (int c = 0; c < 4; c++)
+      planes[p][c] = _mm_set1_ps(frustum.planes[p][c]);
+  const __m128 zero = _mm_setzero_ps();
+
+  size_t written = 0;
+  for (size_t i = 0; i + 4 <= count; i += 4) {
+    __m128 cx = _mm_loadu_ps(x + i), cy = _mm_loadu_ps(y + i), cz = _mm_loadu_ps(z + i);
+    __m128 limit = _mm_sub_ps(zero, _mm_loadu_ps(radius + i));
+    __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (int p = 0; p < 6; p++) {
+      __m128 distance = _mm_add_ps(_mm_mul_ps(planes[p][0], cx), _mm_mul_ps(planes[p][1], cy));
+      distance = _mm_add_ps(distance, _mm_mul_ps(planes[p][2], cz));
+      distance = _mm_add_ps(distance, planes[p][3]);
+      inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, limit));
+    }
+    written = compact4(visible, written, _mm_movemask_ps(inside), firstIndex + (uint32_t)i);
+  }
+  return written;
+}
+
+static size_t cullBoxesSSE(const Frustum &frustum, const float *minX, const float *minY, const float *minZ,
+                           const float *maxX, const float *maxY, const float *maxZ, size_t count,
+                           uint32_t *visible, uint32_t firstIndex) {
+  __m128 planes[6][4];
+  for (int p = 0; p < 6; p++)
+    for (int c = 0; c < 4; c++)
+      planes[p][c] = _mm_set1_ps(frustum.planes[p][c]);
+  const __m128 zero = _mm_setzero_ps();
+
+  size_t written = 0;
+  for (size_t i = 0; i + 4 <= count; i += 4) {
+    __m128 lx = _mm_loadu_ps(minX + i), ly = _mm_loadu_ps(minY + i), lz = _mm_loadu_ps(minZ + i);
+    __m128 hx = _mm_loadu_ps(maxX + i), hy = _mm_loadu_ps(maxY + i), hz = _mm_loadu_ps(maxZ + i);
+    __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (int p = 0; p < 6; p++) {
+      __m128 distance = _mm_add_ps(_mm_max_ps(_mm_mul_ps(planes[p][0], lx), _mm_mul_ps(planes[p][0], hx)),
+                                   _mm_max_ps(_mm_mul_ps(planes[p][1], ly), _mm_mul_ps(planes[p][1], hy)));
+      distance = _mm_add_ps(distance, _mm_max_ps(_mm_mul_ps(planes[p][2], lz), _mm_mul_ps(planes[p][2], hz)));
+      distance = _mm_add_ps(distance, planes[p][3]);
+      inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, zero));
+    }
+    written = compact4(visible, written, _mm_movemask_ps(inside), firstIndex + (uint32_t)i);
+  }
+  return written;
+}
+
+// Append the indices of the lanes set in an 8-lane mask with one permute and one store; always
+// stores eight, so visible needs room for eight past the current count
+__attribute__((target("avx2"))) static inline size_t
+compact8(uint32_t *visible, size_t written, int mask, __m256i indices) {
+  __m256i order = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128((long long)COMPACT8.order[mask]));
+  _mm256_storeu_si256((__m256i *)(visible + written), _mm256_permutevar8x32_epi32(indices, order));
+  return written + __builtin_popcount(mask);
+}
+
+// Eight spheres per iteration with AVX2, compiled for that target only. Without FMA, so results
+// match the other paths exactly.
+__attribute__((target("avx2"))) static size_t
+cullSpheresAVX2(const Frustum &frustum, const float *x, const float *y, const float *z,
+                const float *radius, size_t count, uint32_t *visible, uint32_t firstIndex) {
+  __m256 planes[6][4];
+  for (int p = 0; p < 6; p++)
+    for (int c = 0; c < 4; c++)
+      planes[p][c] = _mm256_set1_ps(frustum.planes[p][c]);
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+  size_t written = 0;
+  for (size_t i = 0; i + 8 <= count; i += 8) {
+    __m256 cx = _mm256_loadu_ps(x + i), cy = _mm256_loadu_ps(y + i), cz = _mm256_loadu_ps(z + i);
+    __m256 limit = _mm256_sub_ps(zero, _mm256_loadu_ps(radius + i));
+    __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (int p = 0; p < 6; p++) {
+      __m256 distance = _mm256_add_ps(_mm256_mul_ps(planes[p][0], cx), _mm256_mul_ps(planes[p][1], cy));
+      distance = _mm256_add_ps(distance, _mm256_mul_ps(planes[p][2], cz));
+      distance = _mm256_add_ps(distance, planes[p][3]);
+      inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, limit, _CMP_GE_OQ));
+    }
+    __m256i indices = _mm256_add_epi32(lanes, _mm256_set1_epi32((int)(firstIndex + (uint32_t)i)));
+    written = compact8(visible, written, _mm256_movemask_ps(inside), indices);
+  }
+  return written;
+}
+
+__attribute__((target("avx2"))) static size_t
+cullBoxesAVX2(const Frustum &frustum, const float *minX, const float *minY, const float *minZ,
+              const float *maxX, const float *maxY, const float *maxZ, size_t count,
+              uint32_t *visible, uint32_t firstIndex) {
+  __m256 planes[6][4];
+  for (int p = 0; p < 6; p++)
+    for (int c = 0; c < 4; c++)
+      planes[p][c] = _mm256_set1_ps(frustum.planes[p][c]);
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+  size_t written = 0;
+  for (size_t i = 0; i + 8 <= count; i += 8) {
+    __m256 lx = _mm256_loadu_ps(minX + i), ly = _mm256_loadu_ps(minY + i), lz = _mm256_loadu_ps(minZ + i);
+    __m256 hx = _mm256_loadu_ps(maxX + i), hy = _mm256_loadu_ps(maxY + i), hz = _mm256_loadu_ps(maxZ + i);
+    __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (int p = 0; p < 6; p++) {
+      __m256 distance =
+          _mm256_add_ps(_mm256_max_ps(_mm256_mul_ps(planes[p][0], lx), _mm256_mul_ps(planes[p][0], hx)),
+                        _mm256_max_ps(_mm256_mul_ps(planes[p][1], ly), _mm256_mul_ps(planes[p][1], hy)));
+      distance = _mm256_add_ps(distance,
+                               _mm256_max_ps(_mm256_mul_ps(planes[p][2], lz), _mm256_mul_ps(planes[p][2], hz)));
+      distance = _mm256_add_ps(distance, planes[p][3]);
+      inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, zero, _CMP_GE_OQ));
+    }
+    __m256i indices = _mm256_add_epi32(lanes, _mm256_set1_epi32((int)(firstIndex + (uint32_t)i)));
+    written = compact8(visible, written, _mm256_movemask_ps(inside), indices);
+  }
+  return written;
+}
+
+static bool hasAVX2() {
+  static const bool supported = __builtin_cpu_supports("avx2");
+  return supported;
+}
+
+#endif // FRUSTUM_CULLING_X86
+
+size_t cullSpheres(const Frustum &frustum, const float *x, const float *y, const float *z,
+                   const float *radius, size_t count, uint32_t *visible, uint32_t firstIndex) {
+  size_t done = 0, written = 0;
+
+#ifdef FRUSTUM_CULLING_X86
+  if (hasAVX2()) {
+    written = cullSpheresAVX2(frustum, x, y, z, radius, count, visible, firstIndex);
+    done = count & ~(size_t)7;
+  }
+  // a leftover group of four still takes the SSE kernel
+  written += cullSpheresSSE(frustum, x + done, y + done, z + done, radius + done, count - done,
+                            visible + written, firstIndex + (uint32_t)done);
+  done += (count - done) & ~(size_t)3;
+#endif
+
+  written += cullSpheresScalar(frustum, x + done, y + done, z + done, radius + done, count - done,
+                               visible + written, firstIndex + (uint32_t)done);
+  return written;
+}
+
+size_t cullBoxes(const Frustum &frustum, const float *minX, const float *minY, const float *minZ,
+                 const float *maxX, const float *maxY, const float *maxZ, size_t count,
+                 uint32_t *visible, uint32_t firstIndex) {
+  size_t done = 0, written = 0;
+
+#ifdef FRUSTUM_CULLING_X86
+  if (hasAVX2()) {
+    written = cullBoxesAVX2(frustum, minX, minY, minZ, maxX, maxY, maxZ, count, visible, firstIndex);
+    done = count & ~(size_t)7;
+  }
+  written += cullBoxesSSE(frustum, minX + done, minY + done, minZ + done, maxX + done, maxY + done,
+                          maxZ + done, count - done, visible + written, firstIndex + (uint32_t)done);
+  done += (count - done) & ~(size_t)3;
+#endif
+
+  written += cullBoxesScalar(frustum, minX + done, minY + done, minZ + done, maxX + done, maxY + done,
+                             maxZ + done, count - done, visible + written, firstIndex + (uint32_t)done);
+  return written;
+}
@@ -0,0 +1,131 @@
+#include <string.h>
+
+#include "GLExtensions.h"
+
+GLExtensions glExtensions;
+
+#ifndef GL_VERSION_4_1
+PFNGLGETPROGRAMBINARYPROC glad_glGetProgramBinary = NULL;
+PFNGLPROGRAMBINARYPROC glad_glProgramBinary = NULL;
+PFNGLPROGRAMPARAMETERIPROC glad_glProgramParameteri = NULL;
+#endif
+
+#ifndef GL_KHR_parallel_shader_compile
+PFNGLMAXSHADERCOMPILERTHREADSKHRPROC glad_glMaxShaderCompilerThreadsKHR = NULL;
+#endif
+
+#ifndef GL_VERSION_4_2
+PFNGLMEMORYBARRIERPROC glad_glMemoryBarrier = NULL;
+#endif
+
+#ifndef GL_VERSION_4_3
+PFNGLDISPATCHCOMPUTEPROC glad_glDispatchCompute = NULL;
+PFNGLMULTIDRAWELEMENTSINDIRECTPROC glad_glMultiDrawElementsIndirect = NULL;
+#endif
+
+#ifndef GL_KHR_debug
+PFNGLPUSHDEBUGGROUPPROC glad_glPushDebugGroup = NULL;
+PFNGLPOPDEBUGGROUPPROC glad_glPopDebugGroup = NULL;
+#endif
+
+#ifndef GL_VERSION_4_4
+PFNGLBUFFERSTORAGEPROC glad_glBufferStorage = NULL;
+#endif
+
+#ifndef GL_ARB_indirect_parameters
+PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTARBPROC glad_glMultiDrawElementsIndirectCountARB = NULL;
+#endif
+
+static bool atLeast(int major, int minor) {
+  return glExtensions.major > major ||
+         (glExtensions.major == major && glExtensions.minor >= minor);
+}
+
+bool hasGLExtension(const char *name) {
+  int count = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+  for (int i = 0; i < count; i++) {
+    const char *extension = (const char *)glGetStringi(GL_EXTENSIONS, i);
+    if (extension && strcmp(extension, name) == 0)
+      return true;
+  }
+  return false;
+}
+
+void loadGLExtensions(GLADloadfunc load) {
+  glExtensions = GLExtensions();
+  glGetIntegerv(GL_MAJOR_VERSION, &glExtensions.major);
+  glGetIntegerv(GL_MINOR_VERSION, &glExtensions.minor);
+
+  // program binaries
+  // ------------------------------------
+#ifndef GL_VERSION_4_1
+  glad_glGetProgramBinary = (PFNGLGETPROGRAMBINARYPROC)load("glGetProgramBinary");
+  glad_glProgramBinary = (PFNGLPROGRAMBINARYPROC)load("glProgramBinary");
+  glad_glProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC)load("glProgramParameteri");
+#endif
+  if ((atLeast(4, 1) || hasGLExtension("GL_ARB_get_program_binary")) &&
+      glGetProgramBinary && glProgramBinary && glProgramParameteri) {
+    int formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    glExtensions.programBinary = formats > 0;
+  }
+
+  // parallel shader compilation, the ARB variant shares the enums of the KHR one
+  // ------------------------------------
+  glad_glMaxShaderCompilerThreadsKHR = NULL;
+  if (hasGLExtension("GL_KHR_parallel_shader_compile")) {
+    glad_glMaxShaderCompilerThreadsKHR =
+        (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)load("glMaxShaderCompilerThreadsKHR");
+  } else if (hasGLExtension("GL_ARB_parallel_shader_compile")) {
+    glad_glMaxShaderCompilerThreadsKHR =
+        (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)load("glMaxShaderCompilerThreadsARB");
+  }
+  glExtensions.parallelShaderCompile = glMaxShaderCompilerThreadsKHR != NULL;
+
+  // GPU driven drawing: compute culling feeding one multi-draw
+  // ------------------------------------
+#ifndef GL_VERSION_4_2
+  glad_glMemoryBarrier = (PFNGLMEMORYBARRIERPROC)load("glMemoryBarrier");
+#endif
+#ifndef GL_VERSION_4_3
+  glad_glDispatchCompute = (PFNGLDISPATCHCOMPUTEPROC)load("glDispatchCompute");
+  glad_glMultiDrawElementsIndirect =
+      (PFNGLMULTIDRAWELEMENTSINDIRECTPROC)load("glMultiDrawElementsIndirect");
+#endif
+  glExtensions.multiDrawIndirect = atLeast(4, 3) && glMemoryBarrier &&
+                                   glDispatchCompute && glMultiDrawElementsIndirect;
+
+#ifndef GL_ARB_indirect_parameters
+  glad_glMultiDrawElementsIndirectCountARB = NULL;
+  if (atLeast(4, 6))
+    glad_glMultiDrawElementsIndirectCountARB =
+        (PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTARBPROC)load("glMultiDrawElementsIndirectCount");
+  else if (hasGLExtension("GL_ARB_indirect_parameters"))
+    glad_glMultiDrawElementsIndirectCountARB =
+        (PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTARBPROC)load("glMultiDrawElementsIndirectCountARB");
+#endif
+  glExtensions.indirectParameters =
+      glExtensions.multiDrawIndirect && glMultiDrawElementsIndirectCountARB != NULL;
+
+  // persistently mapped buffers
+  // ------------------------------------
+#ifndef GL_VERSION_4_4
+  glad_glBufferStorage = NULL;
+  if (atLeast(4, 4) || hasGLExtension("GL_ARB_buffer_storage"))
+    glad_glBufferStorage = (PFNGLBUFFERSTORAGEPROC)load("glBufferStorage");
+#endif
+  glExtensions.bufferStorage = glBufferStorage != NULL;
+
+  // debug groups, same entry point names in core 4.3 and desktop KHR_debug
+  // ------------------------------------
+#ifndef GL_KHR_debug
+  glad_glPushDebugGroup = NULL;
+  glad_glPopDebugGroup = NULL;
+  if (atLeast(4, 3) || hasGLExtension("GL_KHR_debug")) {
+    glad_glPushDebugGroup = (PFNGLPUSHDEBUGGROUPPROC)load("glPushDebugGroup");
+    glad_glPopDebugGroup = (PFNGLPOPDEBUGGROUPPROC)load("glPopDebugGroup");
+  }
+#endif
+  glExtensions.debugGroups = glPushDebugGroup && glPopDebugGroup;
+}
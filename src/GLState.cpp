@@ -0,0 +1,103 @@
+#include "GLState.h"
+
+GLStateCache glState;
+
+// Slot of a texture target in the per-unit table, or -1 for untracked targets
+static int targetSlot(GLenum target) {
+  switch (target) {
+  case GL_TEXTURE_2D:
+    return 0;
+  case GL_TEXTURE_CUBE_MAP:
+    return 1;
+  case GL_TEXTURE_2D_ARRAY:
+    return 2;
+  case GL_TEXTURE_3D:
+    return 3;
+  default:
+    return -1;
+  }
+}
+
+void GLStateCache::useProgram(unsigned int program) {
+  if (_program == program) {
+    _current.elided++;
+    return;
+  }
+  glUseProgram(program);
+  _program = program;
+  _current.issued++;
+}
+
+void GLStateCache::bindVertexArray(unsigned int vao) {
+  if (_vao == vao) {
+    _current.elided++;
+    return;
+  }
+  glBindVertexArray(vao);
+  _vao = vao;
+  _current.issued++;
+}
+
+void GLStateCache::activeTexture(unsigned int unit) {
+  if (_activeUnit == unit) {
+    _current.elided++;
+    return;
+  }
+  glActiveTexture(GL_TEXTURE0 + unit);
+  _activeUnit = unit;
+  _current.issued++;
+}
+
+void GLStateCache::bindTexture(unsigned int unit, GLenum target,
+                               unsigned int texture) {
+  int slot = targetSlot(target);
+  if (unit < MAX_TEXTURE_UNITS && slot >= 0 &&
+      _textures[unit][slot] == texture) {
+    _current.elided++;
+    return;
+  }
+  activeTexture(unit);
+  glBindTexture(target, texture);
+  if (unit < MAX_TEXTURE_UNITS && slot >= 0)
+    _textures[unit][slot] = texture;
+  _current.issued++;
+}
+
+void GLStateCache::bindSampler(unsigned int unit, unsigned int sampler) {
+  if (unit < MAX_TEXTURE_UNITS && _samplers[unit] == sampler) {
+    _current.elided++;
+    return;
+  }
+  glBindSampler(unit, sampler);
+  if (unit < MAX_TEXTURE_UNITS)
+    _samplers[unit] = sampler;
+  _current.issued++;
+}
+
+void GLStateCache::forgetProgram(unsigned int program) {
+  if (_program == program)
+    _program = UNKNOWN;
+}
+
+void GLStateCache::forgetVertexArray(unsigned int vao) {
+  if (_vao == vao)
+    _vao = UNKNOWN;
+}
+
+void GLStateCache::forgetTexture(unsigned int texture) {
+  for (unsigned int unit = 0; unit < MAX_TEXTURE_UNITS; unit++)
+    for (unsigned int slot = 0; slot < TRACKED_TARGETS; slot++)
+      if (_textures[unit][slot] == texture)
+        _textures[unit][slot] = UNKNOWN;
+}
+
+void GLStateCache::invalidate() {
+  _program = UNKNOWN;
+  _vao = UNKNOWN;
+  _activeUnit = UNKNOWN;
+  for (unsigned int unit = 0; unit < MAX_TEXTURE_UNITS; unit++) {
+    for (unsigned int slot = 0; slot < TRACKED_TARGETS; slot++)
+      _textures[unit][slot] = UNKNOWN;
+    _samplers[unit] = UNKNOWN;
+  }
+}
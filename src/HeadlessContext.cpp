@@ -0,0 +1,107 @@
+#include <iostream>
+
+#include "HeadlessContext.h"
+
+#ifdef HAS_EGL
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+bool HeadlessContext::create() {
+  PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+      (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+  if (!getPlatformDisplay) {
+    std::cout << "ERROR::HEADLESS::NO_PLATFORM_DISPLAY" << std::endl;
+    return false;
+  }
+
+  EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+  EGLint major, minor;
+  if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+    std::cout << "ERROR::HEADLESS::DISPLAY_INITIALIZATION_FAILED" << std::endl;
+    return false;
+  }
+  _display = display;
+
+  if (!eglBindAPI(EGL_OPENGL_API)) {
+    std::cout << "ERROR::HEADLESS::OPENGL_API_UNAVAILABLE" << std::endl;
+    destroy();
+    return false;
+  }
+
+  const EGLint configAttributes[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+                                     EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+  EGLConfig config;
+  EGLint configCount = 0;
+  eglChooseConfig(display, configAttributes, &config, 1, &configCount);
+
+  // same versions the windowed path asks GLFW for
+  const EGLint versions[][2] = {{4, 3}, {3, 3}};
+  for (const EGLint *version : versions) {
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, version[0],
+        EGL_CONTEXT_MINOR_VERSION, version[1],
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE};
+    EGLContext context = eglCreateContext(display, configCount > 0 ? config : EGL_NO_CONFIG_KHR,
+                                          EGL_NO_CONTEXT, contextAttributes);
+    if (context != EGL_NO_CONTEXT) {
+      _context = context;
+      break;
+    }
+  }
+
+  if (!_context || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, (EGLContext)_context)) {
+    std::cout << "ERROR::HEADLESS::CONTEXT_CREATION_FAILED" << std::endl;
+    destroy();
+    return false;
+  }
+  return true;
+}
+
+bool HeadlessContext::makeCurrent() {
+  if (!_display || !eglMakeCurrent((EGLDisplay)_display, EGL_NO_SURFACE, EGL_NO_SURFACE, (EGLContext)_context)) {
+    std::cout << "ERROR::HEADLESS::MAKE_CURRENT_FAILED" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+void HeadlessContext::release() {
+  if (_display)
+    eglMakeCurrent((EGLDisplay)_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+}
+
+GLADapiproc HeadlessContext::getProcAddress(const char *name) {
+  return (GLADapiproc)eglGetProcAddress(name);
+}
+
+void HeadlessContext::destroy() {
+  if (_display) {
+    eglMakeCurrent((EGLDisplay)_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (_context)
+      eglDestroyContext((EGLDisplay)_display, (EGLContext)_context);
+    eglTerminate((EGLDisplay)_display);
+  }
+  _display = nullptr;
+  _context = nullptr;
+}
+
+#else
+
+bool HeadlessContext::create() {
+  std::cout << "ERROR::HEADLESS::BUILT_WITHOUT_EGL" << std::endl;
+  return false;
+}
+
+bool HeadlessContext::makeCurrent() { return false; }
+
+void HeadlessContext::release() {}
+
+GLADapiproc HeadlessContext::getProcAddress([[maybe_unused]] const char *name) {
+  return NULL;
+}
+
+void HeadlessContext::destroy() {}
+
+#endif
@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <vector>
+
+#include "GLExtensions.h"
+#include "IndirectDraw.h"
+
+// Storage buffer bindings declared by shaders/cull.comp
+static const unsigned int BOUNDS_BINDING = 0;
+static const unsigned int COMMANDS_BINDING = 1;
+static const unsigned int VISIBLE_COMMANDS_BINDING = 2;
+static const unsigned int VISIBLE_COUNT_BINDING = 3;
+
+// Compaction needs the draw count to come from a buffer, otherwise culled slots are left empty
+static ShaderDefines cullDefines() {
+  ShaderDefines defines;
+  if (glExtensions.indirectParameters)
+    defines.set("COMPACT");
+  return defines;
+}
+
+IndirectDrawList::IndirectDrawList(const char *cullPath)
+    : _cull(cullPath, cullDefines()), _compact(glExtensions.indirectParameters) {
+  _objectCountLocation = _cull.getUniformLocation("objectCount");
+
+  glGenBuffers(1, &_boundsBuffer);
+  glGenBuffers(1, &_commandBuffer);
+  glGenBuffers(1, &_visibleBuffer);
+  glGenBuffers(1, &_countBuffer);
+
+  GLuint zero = 0;
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, _countBuffer);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint), &zero, GL_DYNAMIC_DRAW);
+}
+
+void IndirectDrawList::build(const Mesh &mesh, const InstanceData *instances,
+                             size_t count) {
+  _objectCount = count;
+
+  // bounding sphere of the mesh around its own origin, the point instances translate
+  float meshRadius = 0.0f;
+  for (const Vertex &vertex : mesh.vertices)
+    meshRadius = std::max(meshRadius, glm::length(vertex.Position));
+
+  std::vector<glm::vec4> bounds(count);
+  std::vector<DrawElementsIndirectCommand> commands(count);
+  for (size_t i = 0; i < count; i++) {
+    const glm::mat4 &model = instances[i].model;
+    float scale = std::max(glm::length(glm::vec3(model[0])),
+                           std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+    bounds[i] = glm::vec4(glm::vec3(model[3]), meshRadius * scale);
+    commands[i] = DrawElementsIndirectCommand{(GLuint)mesh.indices.size(), 1, 0, 0, (GLuint)i};
+  }
+
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, _boundsBuffer);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, bounds.size() * sizeof(glm::vec4), bounds.data(), GL_STATIC_DRAW);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, _commandBuffer);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand),
+               commands.data(), GL_STATIC_DRAW);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, _visibleBuffer);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand), NULL,
+               GL_DYNAMIC_DRAW);
+}
+
+void IndirectDrawList::cull() {
+  if (_objectCount == 0 || !_cull.isValid())
+    return;
+
+  if (_compact) {
+    GLuint zero = 0;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _countBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), &zero);
+  }
+
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, BOUNDS_BINDING, _boundsBuffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COMMANDS_BINDING, _commandBuffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, VISIBLE_COMMANDS_BINDING, _visibleBuffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, VISIBLE_COUNT_BINDING, _countBuffer);
+
+  _cull.use();
+  glUniform1i(_objectCountLocation, (int)_objectCount);
+  _cull.dispatch((unsigned int)_objectCount, CULL_GROUP_SIZE);
+
+  // the commands and the count are consumed as indirect arguments, not through storage loads
+  glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+}
+
+void IndirectDrawList::draw(Shader &shader, Mesh &mesh) {
+  if (_objectCount == 0)
+    return;
+
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _visibleBuffer);
+  if (_compact)
+    glBindBuffer(GL_PARAMETER_BUFFER_ARB, _countBuffer);
+  mesh.DrawIndirect(shader, _objectCount, _compact);
+}
+
+void IndirectDrawList::deleteBuffers() {
+  glDeleteBuffers(1, &_boundsBuffer);
+  glDeleteBuffers(1, &_commandBuffer);
+  glDeleteBuffers(1, &_visibleBuffer);
+  glDeleteBuffers(1, &_countBuffer);
+  _cull.deleteShader();
+}
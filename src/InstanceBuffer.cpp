@@ -0,0 +1,36 @@
+#include "GLState.h"
+#include "InstanceBuffer.h"
+
+InstanceBuffer::InstanceBuffer() { glGenBuffers(1, &ID); }
+
+void InstanceBuffer::attach(unsigned int vao, unsigned int buffer, GLintptr offset) {
+  glState.bindVertexArray(vao);
+  glBindBuffer(GL_ARRAY_BUFFER, buffer);
+
+  // a matrix attribute takes one location per column
+  GLsizei stride = sizeof(InstanceData);
+  for (unsigned int column = 0; column < 4; column++) {
+    unsigned int location = INSTANCE_ATTRIBUTE_LOCATION + column;
+    size_t columnOffset = offset + offsetof(InstanceData, model) + column * sizeof(glm::vec4);
+    glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, stride, (void *)columnOffset);
+    glEnableVertexAttribArray(location);
+    glVertexAttribDivisor(location, 1);
+  }
+  for (unsigned int column = 0; column < 3; column++) {
+    unsigned int location = INSTANCE_ATTRIBUTE_LOCATION + 4 + column;
+    size_t columnOffset = offset + offsetof(InstanceData, normalMatrix) + column * sizeof(glm::vec3);
+    glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, stride, (void *)columnOffset);
+    glEnableVertexAttribArray(location);
+    glVertexAttribDivisor(location, 1);
+  }
+}
+
+void InstanceBuffer::upload(const InstanceData *instances, size_t count,
+                            GLenum usage) {
+  // respecifying the whole store orphans the previous one instead of waiting for the GPU
+  glBindBuffer(GL_ARRAY_BUFFER, ID);
+  glBufferData(GL_ARRAY_BUFFER, count * sizeof(InstanceData), instances, usage);
+  _count = count;
+}
+
+void InstanceBuffer::deleteBuffer() { glDeleteBuffers(1, &ID); }
@@ -0,0 +1,258 @@
+#include "JobSystem.h"
+
+JobSystem jobs;
+
+// Worker index of the calling thread in the system it belongs to, -1 outside any pool
+static thread_local JobSystem *threadSystem = nullptr;
+static thread_local int threadWorker = -1;
+
+// Job ring of the calling thread; a slot is reused POOL_SIZE jobs later, once its job has run
+static thread_local std::unique_ptr<Job[]> threadJobs;
+static thread_local unsigned int threadNextJob = 0;
+
+bool JobDeque::push(Job *job) {
+  int64_t bottom = _bottom.load(std::memory_order_relaxed);
+  int64_t top = _top.load(std::memory_order_acquire);
+  if (bottom - top >= CAPACITY)
+    return false;
+
+  _jobs[bottom & (CAPACITY - 1)].store(job, std::memory_order_relaxed);
+  _bottom.store(bottom + 1, std::memory_order_release);
+  return true;
+}
+
+Job *JobDeque::pop() {
+  int64_t bottom = _bottom.load(std::memory_order_relaxed) - 1;
+  _bottom.store(bottom, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t top = _top.load(std::memory_order_relaxed);
+
+  if (top > bottom) {
+    // empty
+    _bottom.store(bottom + 1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  Job *job = _jobs[bottom & (CAPACITY - 1)].load(std::memory_order_relaxed);
+  if (top == bottom) {
+    // last job: race the thieves for it
+    if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed))
+      job = nullptr;
+    _bottom.store(bottom + 1, std::memory_order_relaxed);
+  }
+  return job;
+}
+
+Job *JobDeque::steal() {
+  int64_t top = _top.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t bottom = _bottom.load(std::memory_order_acquire);
+  if (top >= bottom)
+    return nullptr;
+
+  Job *job = _jobs[top & (CAPACITY - 1)].load(std::memory_order_relaxed);
+  if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                    std::memory_order_relaxed))
+    return nullptr;
+  return job;
+}
+
+void JobSystem::start(unsigned int workerCount) {
+  stop();
+
+  _mainThread = std::this_thread::get_id();
+  _stop = false;
+  for (unsigned int i = 0; i <= workerCount; i++) {
+    _workers.push_back(std::make_unique<Worker>());
+    _workers.back()->random = 0x9E3779B9u * (i + 1);
+  }
+  threadSystem = this;
+  threadWorker = 0;
+
+  for (unsigned int i = 1; i <= workerCount; i++)
+    _threads.emplace_back(&JobSystem::workerLoop, this, (int)i);
+}
+
+void JobSystem::stop() {
+  if (_workers.empty())
+    return;
+
+  _stop = true;
+  _epoch.fetch_add(1);
+  _epoch.notify_all();
+  for (std::thread &thread : _threads)
+    thread.join();
+
+  _threads.clear();
+  _workers.clear();
+  _mainQueue.clear();
+  _injected.clear();
+  _mainQueued = 0;
+  _injectedQueued = 0;
+  _run.fetch_add(1, std::memory_order_relaxed);
+  if (threadSystem == this) {
+    threadSystem = nullptr;
+    threadWorker = -1;
+  }
+}
+
+bool JobSystem::isMainThread() const {
+  return _workers.empty() || std::this_thread::get_id() == _mainThread;
+}
+
+int JobSystem::threadIndex() const {
+  if (threadSystem == this)
+    return threadWorker;
+  return _workers.empty() ? 0 : -1;
+}
+
+Job *JobSystem::allocateJob() {
+  if (!threadJobs)
+    threadJobs = std::make_unique<Job[]>(POOL_SIZE);
+  Job *job = &threadJobs[threadNextJob++ & (POOL_SIZE - 1)];
+
+  // the ring wrapped onto a job still queued: help until it has started, rather than overwrite it
+  uint32_t run = _run.load(std::memory_order_relaxed);
+  while (job->run.load(std::memory_order_acquire) == run)
+    runOneJob();
+  job->run.store(run, std::memory_order_relaxed);
+  return job;
+}
+
+void JobSystem::submit(Job *job, bool mainThread) {
+  // not started: everything runs on the caller
+  if (_workers.empty()) {
+    execute(job);
+    return;
+  }
+
+  if (mainThread) {
+    std::lock_guard<std::mutex> lock(_queueMutex);
+    _mainQueue.push_back(job);
+    _mainQueued.fetch_add(1, std::memory_order_release);
+    return;
+  }
+
+  int worker = threadSystem == this ? threadWorker : -1;
+  if (worker >= 0) {
+    // a full deque means the thread is far ahead of the others; running the job now keeps it bounded
+    if (!_workers[worker]->deque.push(job)) {
+      execute(job);
+      return;
+    }
+  } else {
+    std::lock_guard<std::mutex> lock(_queueMutex);
+    _injected.push_back(job);
+    _injectedQueued.fetch_add(1, std::memory_order_release);
+  }
+  wake();
+}
+
+void JobSystem::wake() {
+  // pairs with the increment of _sleeping before a worker's last look for jobs
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (_sleeping.load(std::memory_order_relaxed) > 0) {
+    _epoch.fetch_add(1, std::memory_order_relaxed);
+    _epoch.notify_one();
+  }
+}
+
+Job *JobSystem::findJob(int worker) {
+  if (worker >= 0) {
+    if (Job *job = _workers[worker]->deque.pop())
+      return job;
+  }
+
+  if (_injectedQueued.load(std::memory_order_acquire) > 0) {
+    std::lock_guard<std::mutex> lock(_queueMutex);
+    if (!_injected.empty()) {
+      Job *job = _injected.back();
+      _injected.pop_back();
+      _injectedQueued.fetch_sub(1, std::memory_order_relaxed);
+      return job;
+    }
+  }
+
+  // steal from the others, starting at a random victim so thieves spread out
+  size_t count = _workers.size();
+  uint32_t start = 0;
+  if (worker >= 0) {
+    uint32_t &random = _workers[worker]->random;
+    random ^= random << 13;
+    random ^= random >> 17;
+    random ^= random << 5;
+    start = random;
+  }
+  for (size_t i = 0; i < count; i++) {
+    size_t victim = (start + i) % count;
+    if ((int)victim == worker)
+      continue;
+    if (Job *job = _workers[victim]->deque.steal())
+      return job;
+  }
+  return nullptr;
+}
+
+void JobSystem::execute(Job *job) {
+  JobCounter *counter = job->counter;
+  job->function(*job);
+  // a waiter may return and destroy the counter as soon as this lands
+  counter->_pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void JobSystem::wait(JobCounter &counter) {
+  while (!counter.done())
+    runOneJob();
+}
+
+void JobSystem::runOneJob() {
+  int worker = threadSystem == this ? threadWorker : -1;
+  if (worker == 0 && _mainQueued.load(std::memory_order_acquire) > 0) {
+    runMainThreadJobs();
+    return;
+  }
+  Job *job = _workers.empty() ? nullptr : findJob(worker);
+  if (job)
+    execute(job);
+  else
+    std::this_thread::yield();
+}
+
+void JobSystem::runMainThreadJobs() {
+  std::vector<Job *> queued;
+  {
+    std::lock_guard<std::mutex> lock(_queueMutex);
+    queued.swap(_mainQueue);
+    _mainQueued.fetch_sub((int)queued.size(), std::memory_order_relaxed);
+  }
+  for (Job *job : queued)
+    execute(job);
+}
+
+void JobSystem::workerLoop(int worker) {
+  threadSystem = this;
+  threadWorker = worker;
+
+  while (!_stop.load(std::memory_order_relaxed)) {
+    Job *job = nullptr;
+    for (int spin = 0; spin < 64 && !job; spin++) {
+      job = findJob(worker);
+      if (!job)
+        std::this_thread::yield();
+    }
+
+    if (!job) {
+      // announce the sleep before the last look, so a push either sees us or we see the job
+      _sleeping.fetch_add(1, std::memory_order_seq_cst);
+      uint32_t epoch = _epoch.load(std::memory_order_seq_cst);
+      job = findJob(worker);
+      if (!job && !_stop.load(std::memory_order_relaxed))
+        _epoch.wait(epoch, std::memory_order_seq_cst);
+      _sleeping.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    if (job)
+      execute(job);
+  }
+}
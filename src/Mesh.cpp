@@ -0,0 +1,108 @@
+#include <stdint.h>
+
+#include <iostream>
+
+#include "GLExtensions.h"
+#include "GLState.h"
+#include "Mesh.h"
+
+Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices,
+		   std::vector<Texture> textures)
+	: vertices(std::move(vertices)), indices(std::move(indices)), textures(std::move(textures)) {
+	setupMesh();
+}
+
+void Mesh::setupMesh() {
+	// reorder triangles for the post-transform cache and overdraw, then vertices for fetch locality
+	_stats.cacheBefore = analyzeVertexCache(indices.data(), indices.size(), vertices.size());
+	_stats.fetchBefore = analyzeVertexFetch(indices.data(), indices.size(), vertices.size(), sizeof(Vertex));
+
+	if (!vertices.empty() && !indices.empty()) {
+		optimizeVertexCache(indices.data(), indices.size(), vertices.size());
+		optimizeOverdraw(indices.data(), indices.size(), &vertices[0].Position.x, vertices.size(), sizeof(Vertex));
+		size_t used = optimizeVertexFetch(vertices.data(), vertices.size(), sizeof(Vertex), indices.data(), indices.size());
+		vertices.resize(used);
+	}
+
+	_stats.cacheAfter = analyzeVertexCache(indices.data(), indices.size(), vertices.size());
+	_stats.fetchAfter = analyzeVertexFetch(indices.data(), indices.size(), vertices.size(), sizeof(Vertex));
+
+	for (const Texture& texture : textures)
+		_samplerNames.push_back("material." + texture.type);
+
+	glGenVertexArrays(1, &_VAO);
+	glGenBuffers(1, &_VBO);
+	glGenBuffers(1, &_EBO);
+
+	// smallest layout that keeps the mesh visually intact, see VertexFormat.h
+	_format = chooseVertexFormat(vertices);
+	EncodedVertices encoded = encodeVertices(vertices, _format);
+	_positionOffset = encoded.positionOffset;
+	_positionScale = encoded.positionScale;
+
+	glState.bindVertexArray(_VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, _VBO);
+	glBufferData(GL_ARRAY_BUFFER, encoded.data.size(), encoded.data.data(), GL_STATIC_DRAW);
+
+	// 16-bit indices halve the index buffer whenever every vertex can be addressed
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _EBO);
+	if (vertices.size() <= UINT16_MAX) {
+		std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndices.size() * sizeof(uint16_t), shortIndices.data(), GL_STATIC_DRAW);
+		_indexType = GL_UNSIGNED_SHORT;
+	} else {
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+		_indexType = GL_UNSIGNED_INT;
+	}
+
+	// position, normal and texture coordinate attributes
+	setVertexAttributes(_format);
+}
+
+void Mesh::bindMaterial(Shader& shader) {
+	for (unsigned int i = 0; i < textures.size(); i++) {
+		glState.bindTexture(i, GL_TEXTURE_2D, textures[i].id);
+		shader.setInt(_samplerNames[i], (int)i);
+	}
+	shader.set(_positionOffsetUniform, _positionOffset);
+	shader.set(_positionScaleUniform, _positionScale);
+}
+
+void Mesh::Draw(Shader& shader) {
+	bindMaterial(shader);
+	glState.bindVertexArray(_VAO);
+	glDrawElements(GL_TRIANGLES, (GLsizei)indices.size(), _indexType, 0);
+}
+
+void Mesh::DrawInstanced(Shader& shader, size_t instanceCount) {
+	bindMaterial(shader);
+	glState.bindVertexArray(_VAO);
+	glDrawElementsInstanced(GL_TRIANGLES, (GLsizei)indices.size(), _indexType, 0, (GLsizei)instanceCount);
+}
+
+void Mesh::DrawIndirect(Shader& shader, size_t maxDrawCount, bool countFromBuffer) {
+	bindMaterial(shader);
+	glState.bindVertexArray(_VAO);
+	if (countFromBuffer)
+		glMultiDrawElementsIndirectCountARB(GL_TRIANGLES, _indexType, 0, 0, (GLsizei)maxDrawCount, 0);
+	else
+		glMultiDrawElementsIndirect(GL_TRIANGLES, _indexType, 0, (GLsizei)maxDrawCount, 0);
+}
+
+void Mesh::printStats(const char* name) const {
+	std::cout << name << ": " << vertices.size() << " vertices, " << indices.size() / 3 << " triangles, "
+			  << (_indexType == GL_UNSIGNED_SHORT ? 16 : 32) << "-bit indices, "
+			  << vertexFormatName(_format) << " vertices (" << vertexFormatStride(_format) << " bytes, "
+			  << sizeof(Vertex) << " unpacked)\n"
+			  << "  ACMR " << _stats.cacheBefore.acmr << " -> " << _stats.cacheAfter.acmr
+			  << ", ATVR " << _stats.cacheBefore.atvr << " -> " << _stats.cacheAfter.atvr
+			  << ", vertex overfetch " << _stats.fetchBefore.overfetch << " -> " << _stats.fetchAfter.overfetch
+			  << std::endl;
+}
+
+void Mesh::deleteMesh() {
+	glState.forgetVertexArray(_VAO);
+	glDeleteVertexArrays(1, &_VAO);
+	glDeleteBuffers(1, &_VBO);
+	glDeleteBuffers(1, &_EBO);
+}
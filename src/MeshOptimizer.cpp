@@ -0,0 +1,278 @@
+#include <string.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "MeshOptimizer.h"
+
+VertexCacheStats analyzeVertexCache(const unsigned int *indices,
+                                    size_t indexCount, size_t vertexCount,
+                                    unsigned int cacheSize) {
+  VertexCacheStats stats;
+  if (indexCount < 3 || vertexCount == 0)
+    return stats;
+
+  // FIFO cache: a vertex is resident while fewer than cacheSize misses happened since it was loaded
+  std::vector<size_t> loadedAt(vertexCount, 0);
+  std::vector<char> seen(vertexCount, 0);
+  size_t misses = 0;
+  size_t unique = 0;
+
+  for (size_t i = 0; i < indexCount; i++) {
+    unsigned int v = indices[i];
+    if (!seen[v] || misses - loadedAt[v] >= cacheSize) {
+      loadedAt[v] = misses;
+      misses++;
+    }
+    if (!seen[v]) {
+      seen[v] = 1;
+      unique++;
+    }
+  }
+
+  stats.acmr = (float)misses / (float)(indexCount / 3);
+  stats.atvr = (float)misses / (float)unique;
+  return stats;
+}
+
+VertexFetchStats analyzeVertexFetch(const unsigned int *indices,
+                                    size_t indexCount, size_t vertexCount,
+                                    size_t vertexSize) {
+  VertexFetchStats stats;
+  if (indexCount == 0 || vertexCount == 0)
+    return stats;
+
+  // small FIFO cache of 64-byte lines, roughly what a GPU's vertex fetch path holds
+  const size_t lineSize = 64;
+  const size_t cacheLines = 64;
+  size_t lineCount = (vertexCount * vertexSize + lineSize - 1) / lineSize;
+  std::vector<size_t> loadedAt(lineCount, 0);
+  std::vector<char> seen(lineCount, 0);
+  size_t misses = 0;
+
+  for (size_t i = 0; i < indexCount; i++) {
+    size_t first = indices[i] * vertexSize / lineSize;
+    size_t last = (indices[i] * vertexSize + vertexSize - 1) / lineSize;
+    for (size_t line = first; line <= last; line++) {
+      if (!seen[line] || misses - loadedAt[line] >= cacheLines) {
+        seen[line] = 1;
+        loadedAt[line] = misses;
+        misses++;
+      }
+    }
+  }
+
+  stats.bytesFetched = misses * lineSize;
+  stats.overfetch = (float)stats.bytesFetched / (float)(vertexCount * vertexSize);
+  return stats;
+}
+
+void optimizeVertexCache(unsigned int *indices, size_t indexCount,
+                         size_t vertexCount, unsigned int cacheSize) {
+  size_t triangleCount = indexCount / 3;
+  if (triangleCount == 0 || vertexCount == 0)
+    return;
+
+  // vertex to triangle adjacency, stored as offsets into one array
+  std::vector<unsigned int> live(vertexCount, 0);
+  for (size_t i = 0; i < triangleCount * 3; i++)
+    live[indices[i]]++;
+
+  std::vector<unsigned int> offsets(vertexCount + 1, 0);
+  for (size_t v = 0; v < vertexCount; v++)
+    offsets[v + 1] = offsets[v] + live[v];
+
+  std::vector<unsigned int> adjacency(triangleCount * 3);
+  std::vector<unsigned int> cursor(offsets.begin(), offsets.end() - 1);
+  for (size_t i = 0; i < triangleCount * 3; i++)
+    adjacency[cursor[indices[i]]++] = (unsigned int)(i / 3);
+
+  std::vector<size_t> cacheTime(vertexCount, 0);
+  std::vector<char> emitted(triangleCount, 0);
+  std::vector<unsigned int> deadEnd;
+  std::vector<unsigned int> candidates;
+  std::vector<unsigned int> output;
+  deadEnd.reserve(triangleCount * 3);
+  output.reserve(triangleCount * 3);
+
+  size_t time = cacheSize + 1;
+  size_t scan = 0;
+  long long fanning = 0;
+
+  while (fanning >= 0) {
+    // emit every remaining triangle around the fanning vertex
+    candidates.clear();
+    for (unsigned int a = offsets[fanning]; a < offsets[fanning + 1]; a++) {
+      unsigned int triangle = adjacency[a];
+      if (emitted[triangle])
+        continue;
+
+      for (int k = 0; k < 3; k++) {
+        unsigned int v = indices[triangle * 3 + k];
+        output.push_back(v);
+        deadEnd.push_back(v);
+        candidates.push_back(v);
+        live[v]--;
+        if (time - cacheTime[v] > cacheSize) {
+          cacheTime[v] = time;
+          time++;
+        }
+      }
+      emitted[triangle] = 1;
+    }
+
+    // next fanning vertex: the oldest candidate that will still be cached once its triangles are emitted
+    long long next = -1;
+    long long bestPriority = -1;
+    for (unsigned int v : candidates) {
+      if (live[v] == 0)
+        continue;
+      long long priority = 0;
+      if (time - cacheTime[v] + 2 * live[v] <= cacheSize)
+        priority = (long long)(time - cacheTime[v]);
+      if (priority > bestPriority) {
+        bestPriority = priority;
+        next = v;
+      }
+    }
+
+    // dead end: fall back to recently used vertices, then to a linear scan
+    while (next < 0 && !deadEnd.empty()) {
+      unsigned int v = deadEnd.back();
+      deadEnd.pop_back();
+      if (live[v] > 0)
+        next = v;
+    }
+    while (next < 0 && scan < vertexCount) {
+      if (live[scan] > 0)
+        next = (long long)scan;
+      else
+        scan++;
+    }
+
+    fanning = next;
+  }
+
+  std::copy(output.begin(), output.end(), indices);
+}
+
+void optimizeOverdraw(unsigned int *indices, size_t indexCount,
+                      const float *positions, size_t vertexCount,
+                      size_t vertexStride, float threshold) {
+  size_t triangleCount = indexCount / 3;
+  if (triangleCount < 2 || vertexCount == 0)
+    return;
+
+  auto position = [&](unsigned int v) {
+    return (const float *)((const char *)positions + v * vertexStride);
+  };
+
+  // split into clusters wherever the cache order jumps to triangles with no cached vertex
+  std::vector<size_t> clusterStart;
+  std::vector<size_t> loadedAt(vertexCount, 0);
+  std::vector<char> seen(vertexCount, 0);
+  size_t misses = 0;
+  for (size_t t = 0; t < triangleCount; t++) {
+    int triangleMisses = 0;
+    for (int k = 0; k < 3; k++) {
+      unsigned int v = indices[t * 3 + k];
+      if (!seen[v] || misses - loadedAt[v] >= VERTEX_CACHE_SIZE) {
+        seen[v] = 1;
+        loadedAt[v] = misses;
+        misses++;
+        triangleMisses++;
+      }
+    }
+    if (t == 0 || triangleMisses == 3)
+      clusterStart.push_back(t);
+  }
+  clusterStart.push_back(triangleCount);
+  size_t clusterCount = clusterStart.size() - 1;
+  if (clusterCount < 2)
+    return;
+
+  // mesh centroid over referenced vertices
+  float meshCentroid[3] = {0.0f, 0.0f, 0.0f};
+  for (size_t i = 0; i < triangleCount * 3; i++)
+    for (int axis = 0; axis < 3; axis++)
+      meshCentroid[axis] += position(indices[i])[axis];
+  for (int axis = 0; axis < 3; axis++)
+    meshCentroid[axis] /= (float)(triangleCount * 3);
+
+  // clusters facing away from the centre occlude the rest, draw them first
+  std::vector<float> occlusion(clusterCount);
+  for (size_t c = 0; c < clusterCount; c++) {
+    float centroid[3] = {0.0f, 0.0f, 0.0f};
+    float normal[3] = {0.0f, 0.0f, 0.0f};
+    float area = 0.0f;
+
+    for (size_t t = clusterStart[c]; t < clusterStart[c + 1]; t++) {
+      const float *p0 = position(indices[t * 3 + 0]);
+      const float *p1 = position(indices[t * 3 + 1]);
+      const float *p2 = position(indices[t * 3 + 2]);
+      float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+      float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+      float n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2],
+                    e1[0] * e2[1] - e1[1] * e2[0]};
+      float triangleArea = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+      for (int axis = 0; axis < 3; axis++) {
+        centroid[axis] += (p0[axis] + p1[axis] + p2[axis]) / 3.0f * triangleArea;
+        normal[axis] += n[axis];
+      }
+      area += triangleArea;
+    }
+
+    float normalLength = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] +
+                                   normal[2] * normal[2]);
+    float metric = 0.0f;
+    if (area > 0.0f && normalLength > 0.0f) {
+      for (int axis = 0; axis < 3; axis++)
+        metric += (centroid[axis] / area - meshCentroid[axis]) * normal[axis] / normalLength;
+    }
+    occlusion[c] = metric;
+  }
+
+  std::vector<size_t> order(clusterCount);
+  for (size_t c = 0; c < clusterCount; c++)
+    order[c] = c;
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return occlusion[a] > occlusion[b];
+  });
+
+  std::vector<unsigned int> sorted;
+  sorted.reserve(triangleCount * 3);
+  for (size_t c : order)
+    sorted.insert(sorted.end(), indices + clusterStart[c] * 3,
+                  indices + clusterStart[c + 1] * 3);
+
+  // keep the new order only if it does not give back too much of the cache efficiency
+  float before = analyzeVertexCache(indices, triangleCount * 3, vertexCount).acmr;
+  float after = analyzeVertexCache(sorted.data(), sorted.size(), vertexCount).acmr;
+  if (after <= before * threshold)
+    std::copy(sorted.begin(), sorted.end(), indices);
+}
+
+size_t optimizeVertexFetch(void *vertices, size_t vertexCount,
+                           size_t vertexSize, unsigned int *indices,
+                           size_t indexCount) {
+  const unsigned int unused = ~0u;
+  std::vector<unsigned int> remap(vertexCount, unused);
+  unsigned int next = 0;
+
+  for (size_t i = 0; i < indexCount; i++) {
+    unsigned int v = indices[i];
+    if (remap[v] == unused)
+      remap[v] = next++;
+    indices[i] = remap[v];
+  }
+
+  std::vector<char> original((char *)vertices, (char *)vertices + vertexCount * vertexSize);
+  for (size_t v = 0; v < vertexCount; v++) {
+    if (remap[v] != unused)
+      memcpy((char *)vertices + remap[v] * vertexSize, original.data() + v * vertexSize,
+             vertexSize);
+  }
+  return next;
+}
@@ -0,0 +1,235 @@
+#include "Profiler.h"
+
+#ifdef ENABLE_PROFILER
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#include "Benchmark.h"
+#include "GLExtensions.h"
+
+// Thread ID of the GPU track in the trace
+static const unsigned int GPU_TRACK = 1000;
+
+static const std::chrono::steady_clock::time_point profilerEpoch = std::chrono::steady_clock::now();
+
+Profiler profiler;
+
+Profiler::Profiler() {}
+
+int64_t Profiler::now() const {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                              profilerEpoch)
+      .count();
+}
+
+ProfileThreadBuffer &Profiler::threadBuffer() {
+  // buffers outlive their threads so a capture can still be written after a worker exits
+  thread_local ProfileThreadBuffer *buffer = nullptr;
+  if (!buffer) {
+    buffer = new ProfileThreadBuffer();
+    std::lock_guard<std::mutex> lock(_threadsMutex);
+    buffer->id = (unsigned int)_threads.size();
+    buffer->name = "Thread " + std::to_string(buffer->id);
+    _threads.push_back(buffer);
+  }
+  return *buffer;
+}
+
+void Profiler::setThreadName(const char *name) {
+  ProfileThreadBuffer &buffer = threadBuffer();
+  std::lock_guard<std::mutex> lock(_threadsMutex);
+  buffer.name = name;
+}
+
+void Profiler::recordCPU(const char *name, int64_t start, int64_t end) {
+  if (start < 0 || !_recording.load(std::memory_order_relaxed))
+    return;
+
+  // the first event of a capture empties the buffer; only this thread writes to it
+  ProfileThreadBuffer &buffer = threadBuffer();
+  unsigned int generation = _generation.load(std::memory_order_acquire);
+  if (buffer.generation.load(std::memory_order_relaxed) != generation) {
+    buffer.count.store(0, std::memory_order_relaxed);
+    buffer.generation.store(generation, std::memory_order_release);
+  }
+
+  size_t index = buffer.count.load(std::memory_order_relaxed);
+  if (index >= ProfileThreadBuffer::CAPACITY)
+    return;
+  if (buffer.events.empty())
+    buffer.events.resize(ProfileThreadBuffer::CAPACITY);
+
+  buffer.events[index] = ProfileThreadBuffer::Event{name, start, end};
+  buffer.count.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::capture(unsigned int frames, const std::string &path) {
+  if (_recording || _drainFrames > 0 || _framesLeft > 0) {
+    std::cout << "ERROR::PROFILER::CAPTURE_IN_PROGRESS" << std::endl;
+    return;
+  }
+  // recording starts at the next frame boundary
+  _framesLeft = frames;
+  _path = path;
+}
+
+void Profiler::beginFrame() {
+  // the slot about to be reused was issued GPU_LATENCY frames ago; read it if it is ready
+  _gpuFrame = (_gpuFrame + 1) % GPU_LATENCY;
+  collectGPU(_gpuFrames[_gpuFrame], false);
+
+  if (_recording) {
+    if (--_framesLeft == 0) {
+      _recording = false;
+      _drainFrames = GPU_LATENCY + 1;
+    }
+  } else if (_drainFrames > 0) {
+    if (--_drainFrames == 0)
+      writeTrace();
+  } else if (_framesLeft > 0) {
+    // buffers still holding the last capture are skipped by writeTrace and reset by their threads
+    _generation.fetch_add(1, std::memory_order_release);
+    _gpuEvents.clear();
+    _startTicks = ticks();
+    _startNanoseconds = now();
+
+    // GPU timestamps are on their own clock, line them up with the CPU one
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+    _gpuOffset = now() - (int64_t)gpuNow;
+
+    _recording = true;
+  }
+}
+
+int Profiler::beginGPU(const char *name) {
+  if (glExtensions.debugGroups)
+    glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name);
+  if (!_recording)
+    return -1;
+
+  if (!_queriesCreated) {
+    for (GPUFrame &frame : _gpuFrames)
+      glGenQueries(MAX_GPU_SCOPES * 2, frame.queries);
+    _queriesCreated = true;
+  }
+
+  GPUFrame &frame = _gpuFrames[_gpuFrame];
+  if (frame.count >= MAX_GPU_SCOPES)
+    return -1;
+
+  int slot = (int)frame.count++;
+  frame.names[slot] = name;
+  frame.pending = true;
+  glQueryCounter(frame.queries[slot * 2], GL_TIMESTAMP);
+  return slot;
+}
+
+void Profiler::endGPU(int slot) {
+  if (slot >= 0)
+    glQueryCounter(_gpuFrames[_gpuFrame].queries[slot * 2 + 1], GL_TIMESTAMP);
+  if (glExtensions.debugGroups)
+    glPopDebugGroup();
+}
+
+void Profiler::collectGPU(GPUFrame &frame, bool wait) {
+  if (!frame.pending)
+    return;
+
+  // timestamps complete in order, so the last one covers the whole frame
+  GLint available = 1;
+  if (!wait)
+    glGetQueryObjectiv(frame.queries[frame.count * 2 - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+
+  if (available) {
+    for (unsigned int i = 0; i < frame.count; i++) {
+      GLuint64 start = 0, end = 0;
+      glGetQueryObjectui64v(frame.queries[i * 2], GL_QUERY_RESULT, &start);
+      glGetQueryObjectui64v(frame.queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+      _gpuEvents.push_back(ProfileThreadBuffer::Event{frame.names[i], (int64_t)start + _gpuOffset,
+                                                      (int64_t)end + _gpuOffset});
+    }
+  }
+  frame.count = 0;
+  frame.pending = false;
+}
+
+// @param event Scope with start and end in nanoseconds
+static void writeEvent(std::ostream &out, const ProfileThreadBuffer::Event &event, unsigned int track,
+                       bool &first) {
+  char line[320];
+  snprintf(line, sizeof(line),
+           "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", first ? "" : ",\n",
+           escapeJson(event.name).c_str(), track, event.start / 1000.0, (event.end - event.start) / 1000.0);
+  out << line;
+  first = false;
+}
+
+static void writeTrackName(std::ostream &out, const std::string &name, unsigned int track, bool &first) {
+  out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << track
+      << ",\"args\":{\"name\":\"" << escapeJson(name.c_str()) << "\"}}";
+  first = false;
+}
+
+void Profiler::writeTrace() {
+  std::ofstream out(_path, std::ios::trunc);
+  if (!out) {
+    std::cout << "ERROR::PROFILER::FILE_NOT_WRITTEN " << _path << std::endl;
+    return;
+  }
+
+  // CPU events are in ticks; the ticks between the start of the capture and now give their rate
+  int64_t elapsedTicks = ticks() - _startTicks;
+  double nanosecondsPerTick = elapsedTicks > 0 ? (double)(now() - _startNanoseconds) / (double)elapsedTicks : 1.0;
+  unsigned int generation = _generation.load(std::memory_order_relaxed);
+
+  size_t eventCount = _gpuEvents.size();
+  bool first = true;
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+  {
+    std::lock_guard<std::mutex> lock(_threadsMutex);
+    for (ProfileThreadBuffer *buffer : _threads) {
+      writeTrackName(out, buffer->name, buffer->id, first);
+      if (buffer->generation.load(std::memory_order_acquire) != generation)
+        continue;                                           // the thread recorded nothing in this capture
+      size_t count = buffer->count.load(std::memory_order_acquire);
+      for (size_t i = 0; i < count; i++) {
+        ProfileThreadBuffer::Event event = buffer->events[i];
+        event.start = _startNanoseconds + (int64_t)((double)(event.start - _startTicks) * nanosecondsPerTick);
+        event.end = _startNanoseconds + (int64_t)((double)(event.end - _startTicks) * nanosecondsPerTick);
+        writeEvent(out, event, buffer->id, first);
+      }
+      eventCount += count;
+    }
+  }
+
+  writeTrackName(out, "GPU", GPU_TRACK, first);
+  for (const ProfileThreadBuffer::Event &event : _gpuEvents)
+    writeEvent(out, event, GPU_TRACK, first);
+  out << "\n]}\n";
+
+  std::cout << "Profiler: wrote " << eventCount << " events to " << _path << std::endl;
+}
+
+void Profiler::shutdown() {
+  if (_recording || _drainFrames > 0) {
+    _recording = false;
+    _drainFrames = 0;
+    for (GPUFrame &frame : _gpuFrames)
+      collectGPU(frame, true);
+    writeTrace();
+  }
+  _framesLeft = 0;
+
+  if (_queriesCreated) {
+    for (GPUFrame &frame : _gpuFrames)
+      glDeleteQueries(MAX_GPU_SCOPES * 2, frame.queries);
+  }
+  _queriesCreated = false;
+}
+
+#endif // ENABLE_PROFILER
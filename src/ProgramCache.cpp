@@ -0,0 +1,177 @@
+#include <glad/gl.h>
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "GLExtensions.h"
+#include "ProgramCache.h"
+
+// File layout: header followed by the raw program binary
+struct ProgramCacheHeader {
+  uint32_t magic;
+  uint32_t format;
+  uint32_t length;
+  uint32_t reserved;
+  uint64_t key;
+  uint64_t checksum;                                    // hash of the binary, catches damage on disk
+  double buildSeconds;
+};
+
+static const uint32_t PROGRAM_CACHE_MAGIC = 0x32505247; // "GRP2", changed with the layout
+static const uint64_t FNV_OFFSET = 0xcbf29ce484222325ull;
+
+// FNV-1a continued over another block of bytes
+static uint64_t hashCombine(uint64_t hash, std::string_view data) {
+  for (char c : data) {
+    hash ^= (uint8_t)c;
+    hash *= 0x100000001b3ull;
+  }
+  // separator so ("ab", "c") and ("a", "bc") differ
+  hash ^= 0xff;
+  hash *= 0x100000001b3ull;
+  return hash;
+}
+
+static std::string_view glString(GLenum name) {
+  const char *value = (const char *)glGetString(name);
+  return value ? std::string_view(value) : std::string_view();
+}
+
+ProgramCache::ProgramCache(const std::string &directory)
+    : _directory(directory) {
+  _enabled = glExtensions.programBinary;
+
+  uint64_t hash = FNV_OFFSET;
+  hash = hashCombine(hash, glString(GL_VENDOR));
+  hash = hashCombine(hash, glString(GL_RENDERER));
+  hash = hashCombine(hash, glString(GL_VERSION));
+  _driverHash = hash;
+
+  if (_enabled) {
+    std::error_code error;
+    std::filesystem::create_directories(_directory, error);
+    if (error) {
+      std::cout << "ERROR::PROGRAM_CACHE::DIRECTORY_NOT_CREATED\n"
+                << _directory << std::endl;
+      _enabled = false;
+    }
+  }
+}
+
+uint64_t ProgramCache::makeKey(std::string_view vertexSource,
+                               std::string_view fragmentSource,
+                               std::string_view defines) const {
+  uint64_t hash = _driverHash;
+  hash = hashCombine(hash, vertexSource);
+  hash = hashCombine(hash, fragmentSource);
+  hash = hashCombine(hash, defines);
+  return hash;
+}
+
+std::string ProgramCache::pathFor(uint64_t key) const {
+  char name[32];
+  snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+  return _directory + "/" + name;
+}
+
+unsigned int ProgramCache::load(uint64_t key) {
+  if (!_enabled)
+    return 0;
+
+  auto start = std::chrono::steady_clock::now();
+
+  std::string path = pathFor(key);
+  std::ifstream file(path, std::ios::binary);
+  ProgramCacheHeader header;
+  if (!file || !file.read((char *)&header, sizeof(header)) ||
+      header.magic != PROGRAM_CACHE_MAGIC || header.key != key) {
+    _misses++;
+    return 0;
+  }
+
+  // drop an unusable entry and rebuild from source, which stores a fresh one
+  auto discard = [&]() {
+    file.close();
+    std::error_code error;
+    std::filesystem::remove(path, error);
+    _rejected++;
+    _misses++;
+    return 0u;
+  };
+
+  // the length must account for the rest of the file exactly before anything is allocated
+  std::error_code error;
+  uintmax_t fileSize = std::filesystem::file_size(path, error);
+  if (error || header.length == 0 || fileSize != sizeof(header) + (uintmax_t)header.length)
+    return discard();
+
+  std::vector<char> binary(header.length);
+  if (!file.read(binary.data(), binary.size()) ||
+      hashCombine(FNV_OFFSET, std::string_view(binary.data(), binary.size())) != header.checksum)
+    return discard();
+
+  unsigned int program = glCreateProgram();
+  glProgramBinary(program, header.format, binary.data(), header.length);
+
+  int success;
+  glGetProgramiv(program, GL_LINK_STATUS, &success);
+  if (!success) {
+    // driver no longer accepts this binary
+    glDeleteProgram(program);
+    return discard();
+  }
+
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  _hits++;
+  _secondsSaved += header.buildSeconds - elapsed.count();
+  return program;
+}
+
+void ProgramCache::store(uint64_t key, unsigned int program,
+                         double buildSeconds) {
+  if (!_enabled)
+    return;
+
+  int length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0)
+    return;
+
+  std::vector<char> binary(length);
+  GLenum format = 0;
+  glGetProgramBinary(program, length, &length, &format, binary.data());
+
+  ProgramCacheHeader header = {};
+  header.magic = PROGRAM_CACHE_MAGIC;
+  header.format = format;
+  header.length = (uint32_t)length;
+  header.key = key;
+  header.checksum = hashCombine(FNV_OFFSET, std::string_view(binary.data(), length));
+  header.buildSeconds = buildSeconds;
+
+  // write to a temporary file first so a crash never leaves a torn entry
+  std::string path = pathFor(key);
+  std::string temporary = path + ".tmp";
+  {
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    file.write((const char *)&header, sizeof(header));
+    file.write(binary.data(), length);
+    if (!file) {
+      std::cout << "ERROR::PROGRAM_CACHE::WRITE_FAILED\n" << path << std::endl;
+      return;
+    }
+  }
+  std::error_code error;
+  std::filesystem::rename(temporary, path, error);
+}
+
+void ProgramCache::printStats() const {
+  std::cout << "Program cache: " << _hits << " hits, " << _misses
+            << " misses (" << _rejected << " rejected), "
+            << _secondsSaved * 1000.0 << " ms saved" << std::endl;
+}
@@ -0,0 +1,142 @@
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "Profiler.h"
+#include "RenderQueue.h"
+
+// 11-bit digits: six passes cover 64 bits and each histogram stays within the L1 cache
+static const int RADIX_BITS = 11;
+static const int RADIX_PASSES = (64 + RADIX_BITS - 1) / RADIX_BITS;
+static const uint32_t RADIX_BUCKETS = 1u << RADIX_BITS;
+
+// Below this many keys an insertion sort beats building the histograms
+static const size_t INSERTION_SORT_LIMIT = 32;
+
+void radixSortKeys(uint64_t *keys, uint32_t *values, size_t count,
+                   uint64_t *keyScratch, uint32_t *valueScratch) {
+  if (count <= INSERTION_SORT_LIMIT) {
+    for (size_t i = 1; i < count; i++) {
+      uint64_t key = keys[i];
+      uint32_t value = values[i];
+      size_t j = i;
+      for (; j > 0 && keys[j - 1] > key; j--) {
+        keys[j] = keys[j - 1];
+        values[j] = values[j - 1];
+      }
+      keys[j] = key;
+      values[j] = value;
+    }
+    return;
+  }
+
+  // one read of the keys fills the histograms of all digits
+  static thread_local uint32_t histograms[RADIX_PASSES][RADIX_BUCKETS];
+  memset(histograms, 0, sizeof(histograms));
+  for (size_t i = 0; i < count; i++) {
+    uint64_t key = keys[i];
+    for (int digit = 0; digit < RADIX_PASSES; digit++)
+      histograms[digit][(key >> (digit * RADIX_BITS)) & (RADIX_BUCKETS - 1)]++;
+  }
+
+  uint64_t *sourceKeys = keys, *targetKeys = keyScratch;
+  uint32_t *sourceValues = values, *targetValues = valueScratch;
+
+  for (int digit = 0; digit < RADIX_PASSES; digit++) {
+    uint32_t *histogram = histograms[digit];
+    int shift = digit * RADIX_BITS;
+
+    // every key has the same digit here, the pass would not move anything
+    if (histogram[(sourceKeys[0] >> shift) & (RADIX_BUCKETS - 1)] == count)
+      continue;
+
+    uint32_t offset = 0;
+    for (uint32_t bucket = 0; bucket < RADIX_BUCKETS; bucket++) {
+      uint32_t bucketCount = histogram[bucket];
+      histogram[bucket] = offset;
+      offset += bucketCount;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+      uint32_t position = histogram[(sourceKeys[i] >> shift) & (RADIX_BUCKETS - 1)]++;
+      targetKeys[position] = sourceKeys[i];
+      targetValues[position] = sourceValues[i];
+    }
+
+    std::swap(sourceKeys, targetKeys);
+    std::swap(sourceValues, targetValues);
+  }
+
+  if (sourceKeys != keys) {
+    memcpy(keys, sourceKeys, count * sizeof(uint64_t));
+    memcpy(values, sourceValues, count * sizeof(uint32_t));
+  }
+}
+
+RenderQueue::RenderQueue(float nearPlane, float farPlane)
+    : _commands(nearPlane, farPlane) {}
+
+void RenderQueue::append(const CommandBuffer &buffer) {
+  _appended.push_back(&buffer);
+}
+
+size_t RenderQueue::size() const {
+  size_t packets = _commands.size();
+  for (const CommandBuffer *buffer : _appended)
+    packets += buffer->size();
+  return packets;
+}
+
+void RenderQueue::gather(const CommandBuffer &buffer) {
+  for (size_t packet = 0; packet < buffer.size(); packet++) {
+    _keys.push_back(buffer.key(packet));
+    _order.push_back((uint32_t)_packets.size());
+    _packets.push_back(PacketRef{&buffer, (uint32_t)packet});
+  }
+}
+
+void RenderQueue::flush() {
+  _stats = Stats();
+  _stats.commands = (uint32_t)size();
+  if (_stats.commands == 0) {
+    _appended.clear();
+    return;
+  }
+
+  PROFILE_SCOPE("RenderQueue::flush");
+  auto start = std::chrono::steady_clock::now();
+  gather(_commands);
+  for (const CommandBuffer *buffer : _appended)
+    gather(*buffer);
+  _keyScratch.resize(_keys.size());
+  _orderScratch.resize(_order.size());
+  radixSortKeys(_keys.data(), _order.data(), _keys.size(), _keyScratch.data(),
+                _orderScratch.data());
+  std::chrono::duration<double> sortTime = std::chrono::steady_clock::now() - start;
+  _stats.sortSeconds = sortTime.count();
+
+  // the bind calls themselves go through glState, the keys only count how often state changes
+  PROFILE_GPU_SCOPE("RenderQueue::draw");
+  SortKeyState previous = {};
+  for (size_t i = 0; i < _order.size(); i++) {
+    SortKeyState state = CommandBuffer::keyState(_keys[i]);
+    if (i == 0 || state.program != previous.program)
+      _stats.programChanges++;
+    if (i == 0 || state.material != previous.material)
+      _stats.materialChanges++;
+    if (i == 0 || state.vertexArray != previous.vertexArray)
+      _stats.vertexArrayChanges++;
+    previous = state;
+
+    const PacketRef &ref = _packets[_order[i]];
+    ref.buffer->replay(ref.packet);
+  }
+
+  _commands.clear();
+  _appended.clear();
+  _packets.clear();
+  _keys.clear();
+  _order.clear();
+}
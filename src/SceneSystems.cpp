@@ -0,0 +1,174 @@
+#include <string.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "FrustumCulling.h"
+#include "JobSystem.h"
+#include "SceneSystems.h"
+
+// Rows each job of a system handles; large enough that scheduling is noise next to the work
+static const size_t ROWS_PER_JOB = 4096;
+
+void updateOrbits(EntityStore &store, float time) {
+  store.forEach(TransformComponent | OrbitComponent, [time](Archetype &archetype) {
+    jobs.parallelFor(archetype.size(), ROWS_PER_JOB, [&](size_t begin, size_t end) {
+      for (size_t row = begin; row < end; row++) {
+        const Orbit &orbit = archetype.orbits[row];
+        float angle = time * orbit.speed;
+        archetype.transforms.setTranslation(
+            row, orbit.center + glm::vec3(orbit.radius * std::cos(angle), 0.0f,
+                                          orbit.radius * std::sin(angle)));
+      }
+    });
+  });
+}
+
+void saveTransforms(EntityStore &store) {
+  store.forEach(TransformComponent, [](Archetype &archetype) {
+    archetype.previousTransforms = archetype.transforms;
+  });
+}
+
+void updateTransforms(EntityStore &store, float alpha) {
+  store.forEach(TransformComponent, [alpha](Archetype &archetype) {
+    if (alpha >= 1.0f || archetype.previousTransforms.size() != archetype.size()) {
+      jobs.parallelFor(archetype.size(), ROWS_PER_JOB, [&](size_t begin, size_t end) {
+        archetype.transforms.computeInstances(archetype.instances.data(), begin, end);
+      });
+      return;
+    }
+
+    archetype.drawTransforms.resize(archetype.size());
+    jobs.parallelFor(archetype.size(), ROWS_PER_JOB, [&](size_t begin, size_t end) {
+      archetype.drawTransforms.blend(archetype.previousTransforms, archetype.transforms, alpha, begin, end);
+      archetype.drawTransforms.computeInstances(archetype.instances.data(), begin, end);
+    });
+  });
+}
+
+void updateBounds(EntityStore &store) {
+  store.forEach(TransformComponent | BoundsComponent, [](Archetype &archetype) {
+    // each job flags whether any sphere of its range moved, so culling can skip a still archetype
+    size_t count = archetype.size();
+    std::vector<uint8_t> rangeMoved((count + ROWS_PER_JOB - 1) / ROWS_PER_JOB, 0);
+
+    jobs.parallelFor(count, ROWS_PER_JOB, [&](size_t begin, size_t end) {
+      bool moved = false;
+      for (size_t row = begin; row < end; row++) {
+        const glm::mat4 &model = archetype.instances[row].model;
+        glm::vec4 center = model * glm::vec4(archetype.localX[row], archetype.localY[row],
+                                              archetype.localZ[row], 1.0f);
+
+        // the largest axis scale bounds any rotation of the sphere
+        float scale = std::max(glm::length(glm::vec3(model[0])),
+                               std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+        float radius = archetype.localRadius[row] * scale;
+        moved |= archetype.worldX[row] != center.x || archetype.worldY[row] != center.y ||
+                 archetype.worldZ[row] != center.z || archetype.worldRadius[row] != radius;
+        archetype.worldX[row] = center.x;
+        archetype.worldY[row] = center.y;
+        archetype.worldZ[row] = center.z;
+        archetype.worldRadius[row] = radius;
+      }
+      rangeMoved[begin / ROWS_PER_JOB] = moved;
+    });
+
+    for (uint8_t moved : rangeMoved) {
+      if (moved) {
+        archetype.boundsVersion++;
+        break;
+      }
+    }
+  });
+}
+
+void cullBounds(EntityStore &store, const Frustum &frustum, uint64_t cameraVersion) {
+  store.forEach(BoundsComponent, [&frustum, cameraVersion](Archetype &archetype) {
+    // the last result holds while neither the camera nor the spheres moved
+    if (archetype.culled && archetype.culledCameraVersion == cameraVersion &&
+        archetype.culledBoundsVersion == archetype.boundsVersion)
+      return;
+
+    // each job lists its visible rows at the start of its own range, then the lists are packed
+    size_t count = archetype.size();
+    archetype.visibleRows.resize(count);
+    std::vector<size_t> rangeCounts((count + ROWS_PER_JOB - 1) / ROWS_PER_JOB, 0);
+
+    jobs.parallelFor(count, ROWS_PER_JOB, [&](size_t begin, size_t end) {
+      rangeCounts[begin / ROWS_PER_JOB] =
+          cullSpheres(frustum, archetype.worldX.data() + begin, archetype.worldY.data() + begin,
+                      archetype.worldZ.data() + begin, archetype.worldRadius.data() + begin,
+                      end - begin, archetype.visibleRows.data() + begin, (uint32_t)begin);
+    });
+
+    size_t visible = 0;
+    for (size_t range = 0; range < rangeCounts.size(); range++) {
+      uint32_t *rows = archetype.visibleRows.data();
+      memmove(rows + visible, rows + range * ROWS_PER_JOB, rangeCounts[range] * sizeof(uint32_t));
+      visible += rangeCounts[range];
+    }
+    archetype.visibleCount = visible;
+    archetype.culled = true;
+    archetype.culledCameraVersion = cameraVersion;
+    archetype.culledBoundsVersion = archetype.boundsVersion;
+  });
+}
+
+unsigned int writePointLights(EntityStore &store, LightBlock &lights) {
+  unsigned int count = 0;
+  store.forEach(TransformComponent | PointLightComponent, [&](Archetype &archetype) {
+    for (size_t row = 0; row < archetype.size() && count < MAX_POINT_LIGHTS; row++) {
+      PointLight &light = lights.pointLights[count++];
+      light = archetype.pointLights[row];
+      light.position = glm::vec3(archetype.instances[row].model[3]);
+    }
+  });
+  for (unsigned int i = count; i < MAX_POINT_LIGHTS; i++)
+    lights.pointLights[i] = PointLight();
+  return count;
+}
+
+void recordRenderables(EntityStore &store, const glm::vec3 &cameraPosition,
+                       std::vector<CommandBuffer> &buffers) {
+  store.forEach(TransformComponent | RenderableComponent, [&](Archetype &archetype) {
+    if (archetype.has(InstancedComponent))
+      return;
+
+    jobs.parallelFor(archetype.visibleSize(), ROWS_PER_JOB, [&](size_t begin, size_t end) {
+      CommandBuffer &buffer = buffers[jobs.threadIndex()];
+      for (size_t i = begin; i < end; i++) {
+        size_t row = archetype.visibleRow(i);
+        const Renderable &renderable = archetype.renderables[row];
+        const glm::mat4 &model = archetype.instances[row].model;
+        float depth = glm::length(glm::vec3(model[3]) - cameraPosition);
+        buffer.submit(renderable.pass, *renderable.shader, *renderable.mesh, model, depth);
+      }
+    });
+  });
+}
+
+void gatherInstances(EntityStore &store, uint32_t batch, std::vector<InstanceData> &instances) {
+  store.forEach(TransformComponent | InstancedComponent, [&](Archetype &archetype) {
+    for (size_t i = 0; i < archetype.visibleSize(); i++) {
+      size_t row = archetype.visibleRow(i);
+      if (archetype.instanced[row].batch == batch)
+        instances.push_back(archetype.instances[row]);
+    }
+  });
+}
+
+float nearestInBatch(EntityStore &store, uint32_t batch, const glm::vec3 &cameraPosition, float farPlane) {
+  float nearest = farPlane;
+  store.forEach(BoundsComponent | InstancedComponent, [&](Archetype &archetype) {
+    for (size_t i = 0; i < archetype.visibleSize(); i++) {
+      size_t row = archetype.visibleRow(i);
+      if (archetype.instanced[row].batch != batch)
+        continue;
+      glm::vec3 center(archetype.worldX[row], archetype.worldY[row], archetype.worldZ[row]);
+      float distance = glm::length(center - cameraPosition) - archetype.worldRadius[row];
+      nearest = std::min(nearest, std::max(distance, 0.0f));
+    }
+  });
+  return nearest;
+}
@@ -1,111 +1,181 @@
-#include "Shader.h"
-Shader::Shader(const char *vertexPath, const char *fragmentPath) {
-
-  // 1. retrieve vertex/fragment source code from file paths
-  std::string vertexCode;
-  std::string fragmentCode;
-  std::ifstream vertexFile;
-  std::ifstream fragmentFile;
-
-  vertexFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-  fragmentFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+#include <chrono>
 
-  try {
-    // open files
-    vertexFile.open(vertexPath);
-    fragmentFile.open(fragmentPath);
-
-    std::stringstream vertexStream, fragmentStream;
+#include "CameraBlock.h"
+#include "GLExtensions.h"
+#include "LightBlock.h"
+#include "ProgramCache.h"
+#include "Shader.h"
+#include "ShaderPreprocessor.h"
+Shader::Shader(const char *vertexPath, const char *fragmentPath,
+               ProgramCache *cache)
+    : Shader(vertexPath, fragmentPath, cache, Deferred{}) {
+  wait();
+}
 
-    // read file's buffer contents into streams
-    vertexStream << vertexFile.rdbuf();
-    fragmentStream << fragmentFile.rdbuf();
+Shader::Shader(const char *vertexPath, const char *fragmentPath,
+               ProgramCache *cache, Deferred)
+    : Shader(vertexPath, fragmentPath, ShaderDefines(), cache, Deferred{}) {}
 
-    // close file handlers
-    vertexFile.close();
-    fragmentFile.close();
+Shader::Shader(const char *vertexPath, const char *fragmentPath,
+               const ShaderDefines &defines, ProgramCache *cache, Deferred)
+    : _cache(cache) {
 
-    // convert input stream to string
-    vertexCode = vertexStream.str();
-    fragmentCode = fragmentStream.str();
-  } catch (std::ifstream::failure e) {
-    std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
-  }
+  // 1. retrieve vertex/fragment source code from file paths, expanding
+  // includes and injecting the permutation's defines
+  std::string vertexCode;
+  std::string fragmentCode;
+  preprocessShader(vertexPath, defines, vertexCode);
+  preprocessShader(fragmentPath, defines, fragmentCode);
   const char *vertexSource = vertexCode.c_str();
   const char *fragmentSource = fragmentCode.c_str();
 
-  // 2. compile shaders
-  // ------------------------------------
-  unsigned int vertex, fragment;
-  int success;
-  char infoLog[512];
-
-  // compile vertex shader
-  vertex = glCreateShader(GL_VERTEX_SHADER);
-  glShaderSource(vertex, 1, &vertexSource, NULL);
-  glCompileShader(vertex);
-
-  glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
-  if (!success) {
-    glGetShaderInfoLog(vertex, 512, NULL, infoLog);
-    std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n"
-              << infoLog << std::endl;
+  // reuse a previously linked binary when the driver accepts it
+  if (_cache && _cache->enabled()) {
+    _cacheKey = _cache->makeKey(vertexCode, fragmentCode, defines.str());
+    ID = _cache->load(_cacheKey);
+    if (ID != 0) {
+      _uniforms.build(ID);
+      resetShadow();
+      bindUniformBlocks();
+      _ready = true;
+      return;
+    }
   }
+  _buildStart = std::chrono::steady_clock::now();
 
-  fragment = glCreateShader(GL_FRAGMENT_SHADER);
-  glShaderSource(fragment, 1, &fragmentSource, NULL);
-  glCompileShader(fragment);
+  // 2. submit shaders
+  // ------------------------------------
+  // No status is queried here: every glGet*iv on a compile or link result
+  // waits for the driver, so checks are deferred to wait().
+  _vertex = glCreateShader(GL_VERTEX_SHADER);
+  glShaderSource(_vertex, 1, &vertexSource, NULL);
+  glCompileShader(_vertex);
 
-  glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
-  if (!success) {
-    glGetShaderInfoLog(fragment, 512, NULL, infoLog);
-    std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n"
-              << infoLog << std::endl;
-  }
+  _fragment = glCreateShader(GL_FRAGMENT_SHADER);
+  glShaderSource(_fragment, 1, &fragmentSource, NULL);
+  glCompileShader(_fragment);
 
   // shader program
   ID = glCreateProgram();
-  glAttachShader(ID, vertex);
-  glAttachShader(ID, fragment);
+  glAttachShader(ID, _vertex);
+  glAttachShader(ID, _fragment);
+  if (_cache && _cache->enabled())
+    glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
   glLinkProgram(ID);
+}
+
+bool Shader::poll() {
+  if (_ready)
+    return true;
+
+  // without parallel compile support any status query would block
+  if (!glExtensions.parallelShaderCompile)
+    return false;
+
+  int complete = 0;
+  glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &complete);
+  if (!complete)
+    return false;
+
+  wait();
+  return true;
+}
+
+void Shader::wait() {
+  if (_ready)
+    return;
+
+  int success;
+  char infoLog[512];
 
   glGetProgramiv(ID, GL_LINK_STATUS, &success);
   if (!success) {
+    // only look at the individual stages once linking is known to have failed
+    glGetShaderiv(_vertex, GL_COMPILE_STATUS, &success);
+    if (!success) {
+      glGetShaderInfoLog(_vertex, 512, NULL, infoLog);
+      std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n"
+                << infoLog << std::endl;
+    }
+
+    glGetShaderiv(_fragment, GL_COMPILE_STATUS, &success);
+    if (!success) {
+      glGetShaderInfoLog(_fragment, 512, NULL, infoLog);
+      std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n"
+                << infoLog << std::endl;
+    }
+
     glGetProgramInfoLog(ID, 512, NULL, infoLog);
     std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
               << infoLog << std::endl;
+  } else {
+    _uniforms.build(ID);
+    resetShadow();
+    bindUniformBlocks();
+    if (_cache && _cache->enabled()) {
+      std::chrono::duration<double> buildTime =
+          std::chrono::steady_clock::now() - _buildStart;
+      _cache->store(_cacheKey, ID, buildTime.count());
+    }
   }
 
-  glDeleteShader(vertex);
-  glDeleteShader(fragment);
+  glDeleteShader(_vertex);
+  glDeleteShader(_fragment);
+  _vertex = 0;
+  _fragment = 0;
+  _ready = true;
+}
+
+void Shader::resetShadow() {
+  // locations are normally small and dense; skip filtering for drivers where they are not
+  int maxLocation = _uniforms.maxLocation();
+  _shadow.clear();
+  if (maxLocation >= 0 && maxLocation < 4096)
+    _shadow.resize(maxLocation + 1);
 }
 
-void Shader::use() { glUseProgram(ID); }
+void Shader::bindUniformBlocks() {
+  // GLSL 3.30 has no binding layout qualifier, so shared blocks are attached by name
+  unsigned int camera = glGetUniformBlockIndex(ID, "CameraBlock");
+  if (camera != GL_INVALID_INDEX)
+    glUniformBlockBinding(ID, camera, CAMERA_BLOCK_BINDING);
 
-void Shader::deleteShader() { glDeleteProgram(ID); }
+  unsigned int lights = glGetUniformBlockIndex(ID, "LightBlock");
+  if (lights != GL_INVALID_INDEX)
+    glUniformBlockBinding(ID, lights, LIGHT_BLOCK_BINDING);
+}
+
+void Shader::use() {
+  if (!_ready)
+    wait();
+  glState.useProgram(ID);
+}
+
+void Shader::deleteShader() {
+  glState.forgetProgram(ID);
+  glDeleteProgram(ID);
+}
 
-void Shader::setBool(const std::string &name, bool value) const {
-  glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+void Shader::setBool(std::string_view name, bool value) const {
+  write(getUniformLocation(name), value);
 }
 
-void Shader::setInt(const std::string &name, int value) const {
-  glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+void Shader::setInt(std::string_view name, int value) const {
+  write(getUniformLocation(name), value);
 }
 
-void Shader::setFloat(const std::string &name, float value) const {
-  glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+void Shader::setFloat(std::string_view name, float value) const {
+  write(getUniformLocation(name), value);
 }
 
-void Shader::setMat4(const std::string &name, const glm::mat4 value) const {
-  glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE,
-                     glm::value_ptr(value));
+void Shader::setMat4(std::string_view name, const glm::mat4 value) const {
+  write(getUniformLocation(name), value);
 }
 
-void Shader::setMat3(const std::string &name, const glm::mat3 value) const {
-  glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE,
-                     glm::value_ptr(value));
+void Shader::setMat3(std::string_view name, const glm::mat3 value) const {
+  write(getUniformLocation(name), value);
 }
 
-void Shader::setVec3(const std::string &name, const glm::vec3 value) const {
-  glUniform3f(glGetUniformLocation(ID, name.c_str()), value.x, value.y, value.z);
+void Shader::setVec3(std::string_view name, const glm::vec3 value) const {
+  write(getUniformLocation(name), value);
 }
\ No newline at end of file
@@ -0,0 +1,41 @@
+#include "GLExtensions.h"
+#include "ShaderCompiler.h"
+
+ShaderCompiler::ShaderCompiler() {
+  if (glExtensions.parallelShaderCompile)
+    glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+}
+
+void ShaderCompiler::enqueue(Shader &shader) {
+  if (!shader.isReady())
+    _pending.push_back(&shader);
+}
+
+size_t ShaderCompiler::update(size_t maxBlocking) {
+  size_t finished = 0;
+  size_t blocked = 0;
+
+  for (size_t i = 0; i < _pending.size();) {
+    Shader *shader = _pending[i];
+    if (!shader->poll()) {
+      if (glExtensions.parallelShaderCompile || blocked >= maxBlocking) {
+        i++;
+        continue;
+      }
+      shader->wait();
+      blocked++;
+    }
+
+    // order does not matter, swap the last entry into this slot
+    _pending[i] = _pending.back();
+    _pending.pop_back();
+    finished++;
+  }
+  return finished;
+}
+
+void ShaderCompiler::finish() {
+  for (Shader *shader : _pending)
+    shader->wait();
+  _pending.clear();
+}
@@ -0,0 +1,133 @@
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+
+#include "ShaderPreprocessor.h"
+
+ShaderDefines &ShaderDefines::set(const std::string &name,
+                                  const std::string &value) {
+  _values[name] = value;
+  return *this;
+}
+
+ShaderDefines &ShaderDefines::set(const std::string &name, int value) {
+  return set(name, std::to_string(value));
+}
+
+ShaderDefines &ShaderDefines::set(const ShaderDefines &other) {
+  for (const auto &[name, value] : other._values)
+    _values[name] = value;
+  return *this;
+}
+
+ShaderDefines &ShaderDefines::unset(const std::string &name) {
+  _values.erase(name);
+  return *this;
+}
+
+std::string ShaderDefines::str() const {
+  std::string result;
+  for (const auto &[name, value] : _values)
+    result += "#define " + name + " " + value + "\n";
+  return result;
+}
+
+struct PreprocessState {
+  const ShaderDefines &defines;
+  std::set<std::string> included;
+  int nextFile = 0;
+  bool versionSeen = false;
+};
+
+static bool startsWithDirective(const std::string &line, const char *directive,
+                                size_t &rest) {
+  size_t i = line.find_first_not_of(" \t");
+  if (i == std::string::npos || line[i] != '#')
+    return false;
+  i = line.find_first_not_of(" \t", i + 1);
+  std::string_view name(directive);
+  if (i == std::string::npos || line.compare(i, name.size(), name) != 0)
+    return false;
+  rest = i + name.size();
+  return true;
+}
+
+static bool appendFile(const std::filesystem::path &path,
+                       PreprocessState &state, std::string &output) {
+  std::ifstream file(path);
+  if (!file) {
+    std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ\n"
+              << path.string() << std::endl;
+    return false;
+  }
+  std::stringstream stream;
+  stream << file.rdbuf();
+  std::string source = stream.str();
+
+  int fileIndex = state.nextFile++;
+  std::string line;
+  size_t rest;
+
+  if (fileIndex == 0) {
+    // shaders without #version get the defines at the very top
+    bool hasVersion = false;
+    std::istringstream lines(source);
+    while (!hasVersion && std::getline(lines, line))
+      hasVersion = startsWithDirective(line, "version", rest);
+    if (!hasVersion) {
+      output += state.defines.str();
+      output += "#line 1 0\n";
+      state.versionSeen = true;
+    }
+  } else {
+    output += "#line 1 " + std::to_string(fileIndex) + "\n";
+  }
+
+  std::istringstream lines(source);
+  int lineNumber = 0;
+  while (std::getline(lines, line)) {
+    lineNumber++;
+
+    if (!state.versionSeen && startsWithDirective(line, "version", rest)) {
+      output += line + "\n";
+      output += state.defines.str();
+      output += "#line " + std::to_string(lineNumber + 1) + " 0\n";
+      state.versionSeen = true;
+      continue;
+    }
+
+    if (startsWithDirective(line, "include", rest)) {
+      size_t open = line.find('"', rest);
+      size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+      if (close == std::string::npos) {
+        std::cout << "ERROR::SHADER::MALFORMED_INCLUDE\n"
+                  << path.string() << ":" << lineNumber << std::endl;
+        return false;
+      }
+
+      std::filesystem::path includePath =
+          path.parent_path() / line.substr(open + 1, close - open - 1);
+      std::string key = includePath.lexically_normal().string();
+      if (state.included.insert(key).second) {
+        if (!appendFile(includePath, state, output))
+          return false;
+      }
+      output += "#line " + std::to_string(lineNumber + 1) + " " +
+                std::to_string(fileIndex) + "\n";
+      continue;
+    }
+
+    output += line + "\n";
+  }
+  return true;
+}
+
+bool preprocessShader(const std::string &path, const ShaderDefines &defines,
+                      std::string &output) {
+  PreprocessState state{defines};
+  state.included.insert(std::filesystem::path(path).lexically_normal().string());
+  output.clear();
+  return appendFile(path, state, output);
+}
@@ -0,0 +1,37 @@
+#include "ShaderCompiler.h"
+#include "ShaderVariants.h"
+
+ShaderVariants::ShaderVariants(const char *vertexPath, const char *fragmentPath,
+                               const ShaderDefines &defaults, ProgramCache *cache,
+                               ShaderCompiler *compiler)
+    : _vertexPath(vertexPath), _fragmentPath(fragmentPath), _defaults(defaults),
+      _cache(cache), _compiler(compiler) {}
+
+void ShaderVariants::deleteShaders() {
+  for (auto &[key, shader] : _variants) {
+    shader->wait();
+    shader->deleteShader();
+  }
+  _variants.clear();
+}
+
+Shader &ShaderVariants::get(const ShaderDefines &defines) {
+  // the full set is the key, so a define left at its default and one set to it share a program
+  ShaderDefines permutation = ShaderDefines(_defaults).set(defines);
+  std::string key = permutation.str();
+  auto found = _variants.find(key);
+  if (found != _variants.end())
+    return *found->second;
+
+  auto shader = std::make_unique<Shader>(_vertexPath.c_str(),
+                                         _fragmentPath.c_str(), permutation,
+                                         _cache, Shader::Deferred{});
+  if (_compiler)
+    _compiler->enqueue(*shader);
+  else
+    shader->wait();
+
+  Shader &result = *shader;
+  _variants.emplace(std::move(key), std::move(shader));
+  return result;
+}
@@ -0,0 +1,358 @@
+#include <glm/gtc/type_ptr.hpp>
+
+#include "TransformBatch.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#define TRANSFORM_BATCH_X86 1
+#include <immintrin.h>
+#endif
+
+size_t TransformBatch::add(const glm::vec3 &translation,
+                           const glm::quat &rotation, const glm::vec3 &scale) {
+  _tx.push_back(translation.x);
+  _ty.push_back(translation.y);
+  _tz.push_back(translation.z);
+  _qx.push_back(rotation.x);
+  _qy.push_back(rotation.y);
+  _qz.push_back(rotation.z);
+  _qw.push_back(rotation.w);
+  _sx.push_back(scale.x);
+  _sy.push_back(scale.y);
+  _sz.push_back(scale.z);
+  return _tx.size() - 1;
+}
+
+void TransformBatch::setTranslation(size_t index, const glm::vec3 &translation) {
+  _tx[index] = translation.x;
+  _ty[index] = translation.y;
+  _tz[index] = translation.z;
+}
+
+void TransformBatch::setRotation(size_t index, const glm::quat &rotation) {
+  _qx[index] = rotation.x;
+  _qy[index] = rotation.y;
+  _qz[index] = rotation.z;
+  _qw[index] = rotation.w;
+}
+
+void TransformBatch::setScale(size_t index, const glm::vec3 &scale) {
+  _sx[index] = scale.x;
+  _sy[index] = scale.y;
+  _sz[index] = scale.z;
+}
+
+void TransformBatch::remove(size_t index) {
+  for (std::vector<float> *array :
+       {&_tx, &_ty, &_tz, &_qx, &_qy, &_qz, &_qw, &_sx, &_sy, &_sz}) {
+    (*array)[index] = array->back();
+    array->pop_back();
+  }
+}
+
+void TransformBatch::clear() {
+  for (std::vector<float> *array :
+       {&_tx, &_ty, &_tz, &_qx, &_qy, &_qz, &_qw, &_sx, &_sy, &_sz})
+    array->clear();
+}
+
+void TransformBatch::resize(size_t count) {
+  for (std::vector<float> *array : {&_tx, &_ty, &_tz, &_qx, &_qy, &_qz})
+    array->resize(count, 0.0f);
+  for (std::vector<float> *array : {&_qw, &_sx, &_sy, &_sz})
+    array->resize(count, 1.0f);
+}
+
+static float lerp(float a, float b, float t) {
+  return a + (b - a) * t;
+}
+
+void TransformBatch::blend(const TransformBatch &from, const TransformBatch &to, float alpha,
+                           size_t begin, size_t end) {
+  for (size_t i = begin; i < end; i++) {
+    _tx[i] = lerp(from._tx[i], to._tx[i], alpha);
+    _ty[i] = lerp(from._ty[i], to._ty[i], alpha);
+    _tz[i] = lerp(from._tz[i], to._tz[i], alpha);
+    _sx[i] = lerp(from._sx[i], to._sx[i], alpha);
+    _sy[i] = lerp(from._sy[i], to._sy[i], alpha);
+    _sz[i] = lerp(from._sz[i], to._sz[i], alpha);
+
+    // an unchanged rotation is copied, renormalizing could move it by an ulp
+    glm::quat a = from.rotation(i), b = to.rotation(i);
+    if (a == b) {
+      setRotation(i, b);
+      continue;
+    }
+    if (glm::dot(a, b) < 0.0f)
+      b = -b;
+    setRotation(i, glm::normalize(glm::quat(lerp(a.w, b.w, alpha), lerp(a.x, b.x, alpha),
+                                            lerp(a.y, b.y, alpha), lerp(a.z, b.z, alpha))));
+  }
+}
+
+void TransformBatch::computeInstancesScalar(InstanceData *out) const {
+  computeRange(0, size(), out);
+}
+
+void TransformBatch::computeRange(size_t begin, size_t end,
+                                  InstanceData *out) const {
+  for (size_t i = begin; i < end; i++) {
+    glm::mat4 &model = out[i].model;
+    glm::mat3 &normal = out[i].normalMatrix;
+
+    // rotation matrix of the quaternion, column-major like glm::mat3_cast
+    float x = _qx[i], y = _qy[i], z = _qz[i], w = _qw[i];
+    float r[3][3] = {
+        {1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + w * z), 2.0f * (x * z - w * y)},
+        {2.0f * (x * y - w * z), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + w * x)},
+        {2.0f * (x * z + w * y), 2.0f * (y * z - w * x), 1.0f - 2.0f * (x * x + y * y)}};
+    float s[3] = {_sx[i], _sy[i], _sz[i]};
+
+    for (int c = 0; c < 3; c++) {
+      float inverseScale = 1.0f / s[c];
+      for (int row = 0; row < 3; row++) {
+        model[c][row] = r[c][row] * s[c];
+        normal[c][row] = r[c][row] * inverseScale;
+      }
+      model[c][3] = 0.0f;
+    }
+    model[3] = glm::vec4(_tx[i], _ty[i], _tz[i], 1.0f);
+  }
+}
+
+#ifdef TRANSFORM_BATCH_X86
+
+// Scatter four instances held in SIMD lanes into consecutive InstanceData.
+// model[c][row] holds element (c, row) of each lane's model matrix, normal[c * 3 + row]
+// the same for the normal matrix.
+static inline void storeInstances4(InstanceData *out, const __m128 model[4][4],
+                                   const __m128 normal[9]) {
+  for (int c = 0; c < 4; c++) {
+    __m128 a = model[c][0], b = model[c][1], d = model[c][2], e = model[c][3];
+    _MM_TRANSPOSE4_PS(a, b, d, e);
+    _mm_storeu_ps(&out[0].model[c][0], a);
+    _mm_storeu_ps(&out[1].model[c][0], b);
+    _mm_storeu_ps(&out[2].model[c][0], d);
+    _mm_storeu_ps(&out[3].model[c][0], e);
+  }
+
+  // a mat3 is nine consecutive floats: two transposed groups of four plus the last element
+  for (int group = 0; group < 2; group++) {
+    __m128 a = normal[group * 4 + 0], b = normal[group * 4 + 1];
+    __m128 d = normal[group * 4 + 2], e = normal[group * 4 + 3];
+    _MM_TRANSPOSE4_PS(a, b, d, e);
+    _mm_storeu_ps(glm::value_ptr(out[0].normalMatrix) + group * 4, a);
+    _mm_storeu_ps(glm::value_ptr(out[1].normalMatrix) + group * 4, b);
+    _mm_storeu_ps(glm::value_ptr(out[2].normalMatrix) + group * 4, d);
+    _mm_storeu_ps(glm::value_ptr(out[3].normalMatrix) + group * 4, e);
+  }
+  alignas(16) float last[4];
+  _mm_store_ps(last, normal[8]);
+  for (int lane = 0; lane < 4; lane++)
+    glm::value_ptr(out[lane].normalMatrix)[8] = last[lane];
+}
+
+// Four instances per iteration with SSE, which every x86-64 CPU has
+static size_t computeSSE(const float *const soa[10], size_t count,
+                         InstanceData *out) {
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 two = _mm_set1_ps(2.0f);
+
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 tx = _mm_loadu_ps(soa[0] + i), ty = _mm_loadu_ps(soa[1] + i);
+    __m128 tz = _mm_loadu_ps(soa[2] + i);
+    __m128 qx = _mm_loadu_ps(soa[3] + i), qy = _mm_loadu_ps(soa[4] + i);
+    __m128 qz = _mm_loadu_ps(soa[5] + i), qw = _mm_loadu_ps(soa[6] + i);
+    __m128 sx = _mm_loadu_ps(soa[7] + i), sy = _mm_loadu_ps(soa[8] + i);
+    __m128 sz = _mm_loadu_ps(soa[9] + i);
+
+    __m128 model[4][4];
+    __m128 normal[9];
+    model[0][3] = model[1][3] = model[2][3] = zero;
+    model[3][0] = tx;
+    model[3][1] = ty;
+    model[3][2] = tz;
+    model[3][3] = one;
+
+    __m128 identity = _mm_and_ps(
+        _mm_and_ps(_mm_cmpeq_ps(qx, zero), _mm_cmpeq_ps(qy, zero)),
+        _mm_and_ps(_mm_cmpeq_ps(qz, zero), _mm_cmpeq_ps(qw, one)));
+    __m128 unitScale = _mm_and_ps(_mm_cmpeq_ps(sx, one),
+                                  _mm_and_ps(_mm_cmpeq_ps(sy, one), _mm_cmpeq_ps(sz, one)));
+
+    if (_mm_movemask_ps(_mm_and_ps(identity, unitScale)) == 0xF) {
+      // translation only: rotation and normal matrix are the identity
+      for (int c = 0; c < 3; c++)
+        for (int row = 0; row < 3; row++) {
+          model[c][row] = c == row ? one : zero;
+          normal[c * 3 + row] = model[c][row];
+        }
+    } else {
+      __m128 xx = _mm_mul_ps(qx, qx), yy = _mm_mul_ps(qy, qy), zz = _mm_mul_ps(qz, qz);
+      __m128 xy = _mm_mul_ps(qx, qy), xz = _mm_mul_ps(qx, qz), yz = _mm_mul_ps(qy, qz);
+      __m128 wx = _mm_mul_ps(qw, qx), wy = _mm_mul_ps(qw, qy), wz = _mm_mul_ps(qw, qz);
+
+      __m128 r[3][3] = {
+          {_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))),
+           _mm_mul_ps(two, _mm_add_ps(xy, wz)), _mm_mul_ps(two, _mm_sub_ps(xz, wy))},
+          {_mm_mul_ps(two, _mm_sub_ps(xy, wz)),
+           _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))),
+           _mm_mul_ps(two, _mm_add_ps(yz, wx))},
+          {_mm_mul_ps(two, _mm_add_ps(xz, wy)), _mm_mul_ps(two, _mm_sub_ps(yz, wx)),
+           _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy)))}};
+
+      // uniform scale needs a single reciprocal instead of three
+      __m128 s[3] = {sx, sy, sz};
+      __m128 inverseScale[3];
+      __m128 uniform = _mm_and_ps(_mm_cmpeq_ps(sx, sy), _mm_cmpeq_ps(sx, sz));
+      if (_mm_movemask_ps(uniform) == 0xF) {
+        inverseScale[0] = inverseScale[1] = inverseScale[2] = _mm_div_ps(one, sx);
+      } else {
+        for (int c = 0; c < 3; c++)
+          inverseScale[c] = _mm_div_ps(one, s[c]);
+      }
+
+      for (int c = 0; c < 3; c++)
+        for (int row = 0; row < 3; row++) {
+          model[c][row] = _mm_mul_ps(r[c][row], s[c]);
+          normal[c * 3 + row] = _mm_mul_ps(r[c][row], inverseScale[c]);
+        }
+    }
+
+    storeInstances4(out + i, model, normal);
+  }
+  return i;
+}
+
+// Eight instances per iteration with AVX2 and FMA, compiled for those targets only
+__attribute__((target("avx2,fma"))) static size_t
+computeAVX2(const float *const soa[10], size_t count, InstanceData *out) {
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 two = _mm256_set1_ps(2.0f);
+  const __m256 minusTwo = _mm256_set1_ps(-2.0f);
+
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 tx = _mm256_loadu_ps(soa[0] + i), ty = _mm256_loadu_ps(soa[1] + i);
+    __m256 tz = _mm256_loadu_ps(soa[2] + i);
+    __m256 qx = _mm256_loadu_ps(soa[3] + i), qy = _mm256_loadu_ps(soa[4] + i);
+    __m256 qz = _mm256_loadu_ps(soa[5] + i), qw = _mm256_loadu_ps(soa[6] + i);
+    __m256 sx = _mm256_loadu_ps(soa[7] + i), sy = _mm256_loadu_ps(soa[8] + i);
+    __m256 sz = _mm256_loadu_ps(soa[9] + i);
+
+    __m256 model[4][4];
+    __m256 normal[9];
+    model[0][3] = model[1][3] = model[2][3] = zero;
+    model[3][0] = tx;
+    model[3][1] = ty;
+    model[3][2] = tz;
+    model[3][3] = one;
+
+    __m256 identity = _mm256_and_ps(
+        _mm256_and_ps(_mm256_cmp_ps(qx, zero, _CMP_EQ_OQ), _mm256_cmp_ps(qy, zero, _CMP_EQ_OQ)),
+        _mm256_and_ps(_mm256_cmp_ps(qz, zero, _CMP_EQ_OQ), _mm256_cmp_ps(qw, one, _CMP_EQ_OQ)));
+    __m256 unitScale = _mm256_and_ps(
+        _mm256_cmp_ps(sx, one, _CMP_EQ_OQ),
+        _mm256_and_ps(_mm256_cmp_ps(sy, one, _CMP_EQ_OQ), _mm256_cmp_ps(sz, one, _CMP_EQ_OQ)));
+
+    if (_mm256_movemask_ps(_mm256_and_ps(identity, unitScale)) == 0xFF) {
+      // translation only: rotation and normal matrix are the identity
+      for (int c = 0; c < 3; c++)
+        for (int row = 0; row < 3; row++) {
+          model[c][row] = c == row ? one : zero;
+          normal[c * 3 + row] = model[c][row];
+        }
+    } else {
+      __m256 xx = _mm256_mul_ps(qx, qx), yy = _mm256_mul_ps(qy, qy), zz = _mm256_mul_ps(qz, qz);
+      __m256 xy = _mm256_mul_ps(qx, qy), xz = _mm256_mul_ps(qx, qz), yz = _mm256_mul_ps(qy, qz);
+      __m256 wx = _mm256_mul_ps(qw, qx), wy = _mm256_mul_ps(qw, qy), wz = _mm256_mul_ps(qw, qz);
+
+      __m256 r[3][3] = {
+          {_mm256_fmadd_ps(minusTwo, _mm256_add_ps(yy, zz), one),
+           _mm256_mul_ps(two, _mm256_add_ps(xy, wz)), _mm256_mul_ps(two, _mm256_sub_ps(xz, wy))},
+          {_mm256_mul_ps(two, _mm256_sub_ps(xy, wz)),
+           _mm256_fmadd_ps(minusTwo, _mm256_add_ps(xx, zz), one),
+           _mm256_mul_ps(two, _mm256_add_ps(yz, wx))},
+          {_mm256_mul_ps(two, _mm256_add_ps(xz, wy)), _mm256_mul_ps(two, _mm256_sub_ps(yz, wx)),
+           _mm256_fmadd_ps(minusTwo, _mm256_add_ps(xx, yy), one)}};
+
+      // uniform scale needs a single reciprocal instead of three
+      __m256 s[3] = {sx, sy, sz};
+      __m256 inverseScale[3];
+      __m256 uniform = _mm256_and_ps(_mm256_cmp_ps(sx, sy, _CMP_EQ_OQ),
+                                     _mm256_cmp_ps(sx, sz, _CMP_EQ_OQ));
+      if (_mm256_movemask_ps(uniform) == 0xFF) {
+        inverseScale[0] = inverseScale[1] = inverseScale[2] = _mm256_div_ps(one, sx);
+      } else {
+        for (int c = 0; c < 3; c++)
+          inverseScale[c] = _mm256_div_ps(one, s[c]);
+      }
+
+      for (int c = 0; c < 3; c++)
+        for (int row = 0; row < 3; row++) {
+          model[c][row] = _mm256_mul_ps(r[c][row], s[c]);
+          normal[c * 3 + row] = _mm256_mul_ps(r[c][row], inverseScale[c]);
+        }
+    }
+
+    // scatter each half with the SSE transposes
+    for (int half = 0; half < 2; half++) {
+      __m128 model4[4][4];
+      __m128 normal4[9];
+      for (int c = 0; c < 4; c++)
+        for (int row = 0; row < 4; row++)
+          model4[c][row] = half ? _mm256_extractf128_ps(model[c][row], 1)
+                                : _mm256_castps256_ps128(model[c][row]);
+      for (int n = 0; n < 9; n++)
+        normal4[n] = half ? _mm256_extractf128_ps(normal[n], 1)
+                          : _mm256_castps256_ps128(normal[n]);
+      storeInstances4(out + i + half * 4, model4, normal4);
+    }
+  }
+  return i;
+}
+
+// Whether computeAVX2 can run here, checked once
+static bool hasAVX2() {
+  static const bool supported =
+      __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  return supported;
+}
+
+#endif // TRANSFORM_BATCH_X86
+
+const char *TransformBatch::kernelName() {
+#ifdef TRANSFORM_BATCH_X86
+  return hasAVX2() ? "avx2" : "sse";
+#else
+  return "scalar";
+#endif
+}
+
+void TransformBatch::computeInstances(InstanceData *out, size_t begin, size_t end) const {
+  size_t done = begin;
+
+#ifdef TRANSFORM_BATCH_X86
+  const float *const soa[10] = {_tx.data() + begin, _ty.data() + begin, _tz.data() + begin,
+                                _qx.data() + begin, _qy.data() + begin, _qz.data() + begin,
+                                _qw.data() + begin, _sx.data() + begin, _sy.data() + begin,
+                                _sz.data() + begin};
+  size_t count = end - begin;
+  size_t computed = 0;
+  if (hasAVX2())
+    computed = computeAVX2(soa, count, out + begin);
+  if (computed < count) {
+    // remaining instances that do not fill an AVX2 group still take the SSE kernel
+    const float *const rest[10] = {
+        soa[0] + computed, soa[1] + computed, soa[2] + computed, soa[3] + computed,
+        soa[4] + computed, soa[5] + computed, soa[6] + computed, soa[7] + computed,
+        soa[8] + computed, soa[9] + computed};
+    computed += computeSSE(rest, count - computed, out + begin + computed);
+  }
+  done += computed;
+#endif
+
+  computeRange(done, end, out);
+}
@@ -0,0 +1,94 @@
+#include <glad/gl.h>
+
+#include <iostream>
+
+#include "UniformTable.h"
+
+static uint32_t nextStamp = 1;
+
+void UniformTable::build(unsigned int program) {
+  clear();
+
+  int count = 0;
+  int maxLength = 0;
+  glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+  glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+  if (count <= 0)
+    return;
+
+  std::vector<char> buffer(maxLength + 1);
+  for (int i = 0; i < count; i++) {
+    int length = 0;
+    int size = 0;
+    GLenum type;
+    glGetActiveUniform(program, i, maxLength + 1, &length, &size, &type,
+                       buffer.data());
+    std::string name(buffer.data(), length);
+
+    // members of uniform blocks have no location
+    int location = glGetUniformLocation(program, name.c_str());
+    if (location < 0)
+      continue;
+    insert(name, location);
+
+    // arrays are reported once as "name[0]"; register the bare name and
+    // every element so "lights[3]" resolves without asking the driver later
+    const std::string suffix = "[0]";
+    if (name.size() > suffix.size() &&
+        name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+      std::string base = name.substr(0, name.size() - suffix.size());
+      insert(base, location);
+      for (int element = 1; element < size; element++) {
+        std::string elementName = base + "[" + std::to_string(element) + "]";
+        int elementLocation = glGetUniformLocation(program, elementName.c_str());
+        if (elementLocation >= 0)
+          insert(elementName, elementLocation);
+      }
+    }
+  }
+}
+
+void UniformTable::clear() {
+  _slots.clear();
+  _names.clear();
+  _count = 0;
+  _maxLocation = -1;
+  _stamp = nextStamp++;
+}
+
+void UniformTable::insert(const std::string &name, int location) {
+  // keep the load factor at or below one half so probe sequences stay short
+  if ((_count + 1) * 2 > _slots.size()) {
+    std::vector<Slot> oldSlots = std::move(_slots);
+    std::vector<std::string> oldNames = std::move(_names);
+    size_t capacity = oldSlots.empty() ? 32 : oldSlots.size() * 2;
+    _slots.assign(capacity, Slot());
+    _names.assign(capacity, std::string());
+    _count = 0;
+    for (size_t i = 0; i < oldSlots.size(); i++) {
+      if (oldSlots[i].hash != 0)
+        insert(oldNames[i], oldSlots[i].location);
+    }
+  }
+
+  uint64_t hash = hashUniformName(name);
+  size_t mask = _slots.size() - 1;
+  for (size_t i = hash & mask;; i = (i + 1) & mask) {
+    Slot &slot = _slots[i];
+    if (slot.hash == 0) {
+      slot.hash = hash;
+      slot.location = location;
+      _names[i] = name;
+      _count++;
+      if (location > _maxLocation)
+        _maxLocation = location;
+      return;
+    }
+    if (slot.hash == hash) {
+      if (_names[i] != name)
+        std::cout << "ERROR::SHADER::UNIFORM_HASH_COLLISION\n"
+                  << _names[i] << " and " << name << std::endl;
+      return;
+    }
+  }
+}
@@ -0,0 +1,128 @@
+#include <chrono>
+#include <iostream>
+
+#include "GLExtensions.h"
+#include "UploadRing.h"
+
+// How long a single glClientWaitSync may block before it is retried, in nanoseconds
+static const GLuint64 FENCE_TIMEOUT = 1000000;
+
+UploadRing::UploadRing(size_t bytesPerFrame) {
+  GLint alignment = 256;
+  glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+  _uniformAlignment = (size_t)alignment;
+
+  // sections start on a uniform buffer offset boundary
+  _sectionSize = (bytesPerFrame + _uniformAlignment - 1) / _uniformAlignment * _uniformAlignment;
+  _persistent = glExtensions.bufferStorage;
+
+  glGenBuffers(1, &ID);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, ID);
+  if (_persistent) {
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glBufferStorage(GL_COPY_WRITE_BUFFER, _sectionSize * FRAMES, NULL, flags);
+    _mapped = (unsigned char *)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, _sectionSize * FRAMES, flags);
+    if (!_mapped) {
+      std::cout << "ERROR::UPLOAD_RING::PERSISTENT_MAP_FAILED" << std::endl;
+      _persistent = false;
+      glDeleteBuffers(1, &ID);
+      glGenBuffers(1, &ID);
+      glBindBuffer(GL_COPY_WRITE_BUFFER, ID);
+    }
+  }
+  if (!_persistent)
+    glBufferData(GL_COPY_WRITE_BUFFER, _sectionSize * FRAMES, NULL, GL_STREAM_DRAW);
+}
+
+void UploadRing::beginFrame() {
+  // the section written FRAMES frames ago must have been consumed
+  if (_fences[_frame]) {
+    auto start = std::chrono::steady_clock::now();
+    GLenum status = glClientWaitSync(_fences[_frame], GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    while (status == GL_TIMEOUT_EXPIRED)
+      status = glClientWaitSync(_fences[_frame], 0, FENCE_TIMEOUT);
+    if (status == GL_WAIT_FAILED)
+      std::cout << "ERROR::UPLOAD_RING::FENCE_WAIT_FAILED" << std::endl;
+    std::chrono::duration<double> waited = std::chrono::steady_clock::now() - start;
+    _current.fenceWaitSeconds += waited.count();
+
+    glDeleteSync(_fences[_frame]);
+    _fences[_frame] = 0;
+  }
+
+  _head = 0;
+  _writing = true;
+  if (!_persistent) {
+    // the fence already synchronizes, so the driver must not wait or copy
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ID);
+    _mapped = (unsigned char *)glMapBufferRange(
+        GL_COPY_WRITE_BUFFER, _frame * _sectionSize, _sectionSize,
+        GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_FLUSH_EXPLICIT_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+    if (!_mapped)
+      std::cout << "ERROR::UPLOAD_RING::MAP_FAILED" << std::endl;
+  }
+}
+
+UploadRing::Allocation UploadRing::allocate(size_t size, size_t alignment) {
+  Allocation allocation;
+  if (!_writing || !_mapped)
+    return allocation;
+
+  size_t start = (_head + alignment - 1) / alignment * alignment;
+  if (start + size > _sectionSize) {
+    std::cout << "ERROR::UPLOAD_RING::OUT_OF_SPACE " << size << " bytes" << std::endl;
+    return allocation;
+  }
+
+  size_t sectionStart = _frame * _sectionSize;
+  allocation.data = (_persistent ? _mapped + sectionStart : _mapped) + start;
+  allocation.offset = (GLintptr)(sectionStart + start);
+  allocation.size = (GLsizeiptr)size;
+
+  _current.bytesUploaded += start + size - _head;
+  _head = start + size;
+  return allocation;
+}
+
+void UploadRing::bindRange(GLenum target, unsigned int index, const Allocation &range) {
+  if (range.data)
+    glBindBufferRange(target, index, ID, range.offset, range.size);
+}
+
+void UploadRing::finishWrites() {
+  if (!_writing)
+    return;
+  _writing = false;
+
+  // coherent persistent writes are visible to commands issued after them
+  if (_persistent || !_mapped)
+    return;
+  glBindBuffer(GL_COPY_WRITE_BUFFER, ID);
+  if (_head > 0)
+    glFlushMappedBufferRange(GL_COPY_WRITE_BUFFER, 0, _head);
+  glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+  _mapped = nullptr;
+}
+
+void UploadRing::endFrame() {
+  finishWrites();
+  _fences[_frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  _frame = (_frame + 1) % FRAMES;
+
+  _lastFrame = _current;
+  _current = Stats();
+}
+
+void UploadRing::deleteBuffer() {
+  for (GLsync &fence : _fences) {
+    if (fence)
+      glDeleteSync(fence);
+    fence = 0;
+  }
+  if (_persistent && _mapped) {
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ID);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+  }
+  _mapped = nullptr;
+  glDeleteBuffers(1, &ID);
+}
@@ -0,0 +1,159 @@
+#include <glad/gl.h>
+
+#include <string.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <glm/gtc/packing.hpp>
+
+#include "VertexFormat.h"
+
+// Interleaved layouts as stored in the vertex buffer
+struct PackedVertex {
+	float position[3];
+	uint32_t normal;
+	uint32_t texCoords;
+};
+static_assert(sizeof(PackedVertex) == 20, "PackedVertex must stay tightly packed");
+
+struct QuantizedVertex {
+	int16_t position[4];		// w is padding so the normal stays 4-byte aligned
+	uint32_t normal;
+	uint32_t texCoords;
+};
+static_assert(sizeof(QuantizedVertex) == 16, "QuantizedVertex must stay tightly packed");
+
+// Largest bounds extent whose 16-bit quantization step is still below a tenth of a millimetre
+static const float MAX_QUANTIZED_EXTENT = 6.5f;
+
+// Half floats keep about three decimal digits; beyond this texture coordinates visibly snap
+static const float MAX_HALF_TEXCOORD = 32.0f;
+
+VertexFormat chooseVertexFormat(const std::vector<Vertex>& vertices) {
+	if (vertices.empty())
+		return VertexFormat::Float;
+
+	glm::vec3 minimum = vertices[0].Position;
+	glm::vec3 maximum = vertices[0].Position;
+	float largestTexCoord = 0.0f;
+	for (const Vertex& vertex : vertices) {
+		minimum = glm::min(minimum, vertex.Position);
+		maximum = glm::max(maximum, vertex.Position);
+		largestTexCoord = std::max(largestTexCoord, std::max(std::fabs(vertex.TexCoords.x), std::fabs(vertex.TexCoords.y)));
+	}
+
+	if (largestTexCoord > MAX_HALF_TEXCOORD)
+		return VertexFormat::Float;
+
+	glm::vec3 extent = maximum - minimum;
+	if (std::max(extent.x, std::max(extent.y, extent.z)) <= MAX_QUANTIZED_EXTENT)
+		return VertexFormat::Quantized;
+	return VertexFormat::Packed;
+}
+
+size_t vertexFormatStride(VertexFormat format) {
+	switch (format) {
+	case VertexFormat::Packed:
+		return sizeof(PackedVertex);
+	case VertexFormat::Quantized:
+		return sizeof(QuantizedVertex);
+	default:
+		return sizeof(Vertex);
+	}
+}
+
+static uint32_t packNormal(const glm::vec3& normal) {
+	return glm::packSnorm3x10_1x2(glm::vec4(normal, 0.0f));
+}
+
+static int16_t quantize(float value) {
+	return (int16_t)std::lround(glm::clamp(value, -1.0f, 1.0f) * 32767.0f);
+}
+
+EncodedVertices encodeVertices(const std::vector<Vertex>& vertices, VertexFormat format) {
+	EncodedVertices encoded;
+	encoded.format = format;
+	encoded.stride = vertexFormatStride(format);
+	encoded.data.resize(vertices.size() * encoded.stride);
+
+	if (format == VertexFormat::Float) {
+		if (!vertices.empty())
+			memcpy(encoded.data.data(), vertices.data(), encoded.data.size());
+		return encoded;
+	}
+
+	if (format == VertexFormat::Packed) {
+		PackedVertex* out = (PackedVertex*)encoded.data.data();
+		for (size_t i = 0; i < vertices.size(); i++) {
+			out[i].position[0] = vertices[i].Position.x;
+			out[i].position[1] = vertices[i].Position.y;
+			out[i].position[2] = vertices[i].Position.z;
+			out[i].normal = packNormal(vertices[i].Normal);
+			out[i].texCoords = glm::packHalf2x16(vertices[i].TexCoords);
+		}
+		return encoded;
+	}
+
+	// positions become signed normalized offsets from the centre of the bounds
+	glm::vec3 minimum = vertices.empty() ? glm::vec3(0.0f) : vertices[0].Position;
+	glm::vec3 maximum = minimum;
+	for (const Vertex& vertex : vertices) {
+		minimum = glm::min(minimum, vertex.Position);
+		maximum = glm::max(maximum, vertex.Position);
+	}
+	encoded.positionOffset = (minimum + maximum) * 0.5f;
+	encoded.positionScale = (maximum - minimum) * 0.5f;
+	for (int axis = 0; axis < 3; axis++) {
+		if (encoded.positionScale[axis] <= 0.0f)
+			encoded.positionScale[axis] = 1.0f;
+	}
+
+	QuantizedVertex* out = (QuantizedVertex*)encoded.data.data();
+	for (size_t i = 0; i < vertices.size(); i++) {
+		glm::vec3 local = (vertices[i].Position - encoded.positionOffset) / encoded.positionScale;
+		out[i].position[0] = quantize(local.x);
+		out[i].position[1] = quantize(local.y);
+		out[i].position[2] = quantize(local.z);
+		out[i].position[3] = 0;
+		out[i].normal = packNormal(vertices[i].Normal);
+		out[i].texCoords = glm::packHalf2x16(vertices[i].TexCoords);
+	}
+	return encoded;
+}
+
+void setVertexAttributes(VertexFormat format) {
+	GLsizei stride = (GLsizei)vertexFormatStride(format);
+
+	switch (format) {
+	case VertexFormat::Packed:
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(PackedVertex, position));
+		glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)offsetof(PackedVertex, normal));
+		glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offsetof(PackedVertex, texCoords));
+		break;
+	case VertexFormat::Quantized:
+		glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, stride, (void*)offsetof(QuantizedVertex, position));
+		glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)offsetof(QuantizedVertex, normal));
+		glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offsetof(QuantizedVertex, texCoords));
+		break;
+	default:
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Vertex, Position));
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Vertex, Normal));
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Vertex, TexCoords));
+		break;
+	}
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+	glEnableVertexAttribArray(2);
+}
+
+const char* vertexFormatName(VertexFormat format) {
+	switch (format) {
+	case VertexFormat::Packed:
+		return "packed";
+	case VertexFormat::Quantized:
+		return "quantized";
+	default:
+		return "float";
+	}
+}
@@ -3,19 +3,55 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 #define FRAGMENT_SHADER_PATH PROJECT_ROOT "/shaders/shader.fs"
 #define VERTEX_SHADER_PATH PROJECT_ROOT "/shaders/shader.vs"
 #define VERTEX_SHADER_LIGHT_PATH PROJECT_ROOT "/shaders/lightShader.vs"
 #define FRAGMENT_SHADER_LIGHT_PATH PROJECT_ROOT "/shaders/lightShader.fs"
+#define CULL_SHADER_PATH PROJECT_ROOT "/shaders/cull.comp"
+#define VERTEX_SHADER_UPSCALE_PATH PROJECT_ROOT "/shaders/upscale.vs"
+#define FRAGMENT_SHADER_UPSCALE_PATH PROJECT_ROOT "/shaders/upscale.fs"
+#define PROGRAM_CACHE_PATH PROJECT_ROOT "/shader_cache"
 
 #define WINDOW_WIDTH 800
 #define WINDOW_HEIGHT 600
 #define STB_IMAGE_IMPLEMENTATION
 
+#include "Benchmark.h"
 #include "Camera.h"
+#include "CameraBlock.h"
+#include "EntityStore.h"
+#include "DynamicResolution.h"
+#include "FixedTimestep.h"
+#include "FrameSnapshot.h"
+#include "Framebuffer.h"
+#include "GLExtensions.h"
+#include "GLState.h"
+#include "HeadlessContext.h"
+#include "IndirectDraw.h"
+#include "InputQueue.h"
+#include "InstanceBuffer.h"
+#include "JobSystem.h"
+#include "LightBlock.h"
+#include "Mesh.h"
+#include "Profiler.h"
+#include "ProgramCache.h"
+#include "RenderQueue.h"
+#include "SceneSystems.h"
 #include "Shader.h"
+#include "ShaderCompiler.h"
+#include "ShaderVariants.h"
+#include "UploadRing.h"
 #include "stb_image.h"
 
 const std::string containerPath = PROJECT_ROOT "/resources/container2.png";
@@ -33,299 +69,632 @@ glm::vec3 cubePositions[] = {
     glm::vec3(1.5f, 0.2f, -1.5f),   glm::vec3(-1.3f, 1.0f, -1.5f)
 };
 
-glm::vec3 lightPos(1.2f, 1.0f, 2.0f);
+// instance batch the containers are drawn in
+#define CONTAINER_BATCH 0
+
+// the simulation advances at a fixed rate whatever the frame rate, catching up at most this many steps a frame
+#define SIMULATION_RATE 120
+#define MAX_SIMULATION_STEPS 8
 
 // CAMERA SETUP
 Camera camera(glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3(0.0f, 1.0f, 0.0f), -90.0f,
               0.0f, WINDOW_WIDTH / 2.0f, WINDOW_HEIGHT / 2.0f);
 
-void framebufferSizeCallback(GLFWwindow *window, int width, int height);
-void processInput(GLFWwindow *window, float deltaTime);
+// cursor and scroll events from the GLFW callbacks, applied to the camera once per simulation step
+InputQueue inputEvents;
+
+void processInput(GLFWwindow *window, float deltaTime, glm::vec3 &cameraPosition);
+double eventTime();
 void mouseCallback(GLFWwindow *window, double xpos, double ypos);
 void scrollCallback(GLFWwindow *window, double xoffset, double yoffset);
-unsigned int loadTexture(const std::string &path);
+void loadTextureAsync(const std::string &path, unsigned int &texture, JobCounter &loaded);
+void setLights(LightBlock &lights);
 
-int main() {
+int main(int argc, char **argv) {
 
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-    GLFWwindow *window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT,
-                                          "OpenGL Window", NULL, NULL);
-    if (window == NULL) {
-        std::cout << "Failed to create GLFW window" << std::endl;
-        glfwTerminate();
-        return -1;
+    BenchmarkOptions options;
+    if (!parseBenchmarkOptions(argc, argv, options))
+        return 1;
+    if (options.jobBenchmark) {
+        runJobScalingBenchmark(1000000);
+        return 0;
+    }
+    if (options.cullBenchmark) {
+        runCullingBenchmark(1000000);
+        return 0;
+    }
+    if (options.transformBenchmark) {
+        runTransformBenchmark(1000000);
+        return 0;
+    }
+    if (options.sortBenchmark) {
+        runSortBenchmark(1000000);
+        return 0;
+    }
+    if (options.uniformBenchmark) {
+        runUniformBenchmark(VERTEX_SHADER_PATH, FRAGMENT_SHADER_PATH, 1000000);
+        return 0;
     }
 
-    // create context for the current calling thread
-    glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
-    glfwSetCursorPosCallback(window, mouseCallback);
-    glfwSetScrollCallback(window, scrollCallback);
-    glfwSetInputMode(window, GLFW_CURSOR,
-                     GLFW_CURSOR_DISABLED); // capture the mouse cursor
+    // --headless renders a fixed number of frames offscreen, without a window or a display
+    GLFWwindow *window = NULL;
+    HeadlessContext headlessContext;
+    GLADloadfunc loadFunction = (GLADloadfunc)glfwGetProcAddress;
 
-    if (!gladLoadGL((GLADloadfunc)glfwGetProcAddress)) {
+    if (options.headless) {
+        if (!headlessContext.create()) {
+            std::cout << "Failed to create headless context" << std::endl;
+            return -1;
+        }
+        loadFunction = HeadlessContext::getProcAddress;
+    } else {
+        glfwInit();
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+        // 4.3 enables GPU culled multi-draw, everything else runs on 3.3
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "OpenGL Window", NULL, NULL);
+        if (window == NULL) {
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+            window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "OpenGL Window", NULL, NULL);
+        }
+        if (window == NULL) {
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+
+        // create context for the current calling thread
+        glfwMakeContextCurrent(window);
+        glfwSetCursorPosCallback(window, mouseCallback);
+        glfwSetScrollCallback(window, scrollCallback);
+        glfwSetInputMode(window, GLFW_CURSOR,
+                         GLFW_CURSOR_DISABLED); // capture the mouse cursor
+
+        // unscaled and unaccelerated motion, where the platform has it
+        if (glfwRawMouseMotionSupported())
+            glfwSetInputMode(window, GLFW_RAW_MOUSE_MOTION, GLFW_TRUE);
+    }
+
+    if (!gladLoadGL(loadFunction)) {
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    loadGLExtensions(loadFunction);
+
+    // this thread owns the context while loading and runs the jobs that touch it; the workers take
+    // the rest. Once the frame loop starts the context moves to the render thread.
+    jobs.start(std::max(1u, std::thread::hardware_concurrency()) - 1);
 
     int nrAttributes;
     glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &nrAttributes);
     std::cout << "Maximum number of vertex attributes supported: "
               << nrAttributes << std::endl;
 
-    // set of vertices
-    float vertices[] = {
-		// positions 		// normals 			// texture coords
-		-0.5f, -0.5f, -0.5f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f,
-		0.5f, -0.5f, -0.5f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f,
-		0.5f, 0.5f, -0.5f, 0.0f, 0.0f, -1.0f, 1.0f, 1.0f,
-		0.5f, 0.5f, -0.5f, 0.0f, 0.0f, -1.0f, 1.0f, 1.0f,
-		-0.5f, 0.5f, -0.5f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f,
-		-0.5f, -0.5f, -0.5f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f,
-		-0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
-		0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f,
-		0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f,
-		0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f,
-		-0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f,
-		-0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
-		-0.5f, 0.5f, 0.5f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f,
-		-0.5f, 0.5f, -0.5f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f,
-		-0.5f, -0.5f, -0.5f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f,
-		-0.5f, -0.5f, -0.5f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f,
-		-0.5f, -0.5f, 0.5f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f,
-		-0.5f, 0.5f, 0.5f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f,
-		0.5f, 0.5f, 0.5f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f,
-		0.5f, 0.5f, -0.5f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f,
-		0.5f, -0.5f, -0.5f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f,
-		0.5f, -0.5f, -0.5f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f,
-		0.5f, -0.5f, 0.5f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f,
-		0.5f, 0.5f, 0.5f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f,
-		-0.5f, -0.5f, -0.5f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f,
-		0.5f, -0.5f, -0.5f, 0.0f, -1.0f, 0.0f, 1.0f, 1.0f,
-		0.5f, -0.5f, 0.5f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f,
-		0.5f, -0.5f, 0.5f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f,
-		-0.5f, -0.5f, 0.5f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f,
-		-0.5f, -0.5f, -0.5f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f,
-		-0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f,
-		0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f,
-		0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f,
-		0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f,
-		-0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f,
-		-0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f
-	};
-
-    Shader shader = Shader(VERTEX_SHADER_PATH, FRAGMENT_SHADER_PATH);
-    Shader lightShader = Shader(VERTEX_SHADER_LIGHT_PATH, FRAGMENT_SHADER_LIGHT_PATH);
-
-    unsigned int VBO, VAO;
-
-    // generate buffer objects and vertex array object
-    glGenBuffers(1, &VBO);
-    glGenVertexArrays(1, &VAO);
-
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float),(void *)0);
-    glEnableVertexAttribArray(0);
-
-    // normal attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-	// texture coordinate attribute
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)(6 * sizeof(float)));
-	glEnableVertexAttribArray(2);
-
-	// set up light VAO
-    unsigned int lightVAO;
-    glGenVertexArrays(1, &lightVAO);
-    glBindVertexArray(lightVAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)0);
-    glEnableVertexAttribArray(0);
-
-	unsigned int diffuseMap = loadTexture(containerPath);
-	unsigned int specularMap = loadTexture(containerSpecularPath);
+    // submit every program up front; the driver compiles them while buffers and textures load
+    ProgramCache programCache(PROGRAM_CACHE_PATH);
+    ShaderCompiler shaderCompiler;
+    // every define shader.fs tests, off unless a permutation turns it on
+    ShaderDefines litDefaults = ShaderDefines()
+        .set("NUM_POINT_LIGHTS", 0)
+        .set("HAS_DIR_LIGHT", 0)
+        .set("HAS_SPOT_LIGHT", 0)
+        .set("HAS_SPECULAR_MAP", 0);
+    ShaderVariants litShaders(VERTEX_SHADER_PATH, FRAGMENT_SHADER_PATH, litDefaults, &programCache, &shaderCompiler);
+    Shader &shader = litShaders.get(ShaderDefines()
+        .set("NUM_POINT_LIGHTS", 1)
+        .set("HAS_DIR_LIGHT")
+        .set("HAS_SPOT_LIGHT")
+        .set("HAS_SPECULAR_MAP"));
+    Shader lightShader = Shader(VERTEX_SHADER_LIGHT_PATH, FRAGMENT_SHADER_LIGHT_PATH, &programCache, Shader::Deferred{});
+    shaderCompiler.enqueue(lightShader);
+
+	// images decode on the workers while the programs compile; the uploads run here during the wait
+	unsigned int diffuseMap = 0, specularMap = 0;
+	JobCounter texturesLoaded;
+	loadTextureAsync(containerPath, diffuseMap, texturesLoaded);
+	loadTextureAsync(containerSpecularPath, specularMap, texturesLoaded);
+	jobs.wait(texturesLoaded);
 	if (diffuseMap == 0 || specularMap == 0) return 1;
+
+	// indexed cube: 24 unique vertices, one set of four per face
+	std::vector<Vertex> cubeVertices = {
+		// positions 					// normals 					// texture coords
+		{{-0.5f, -0.5f, -0.5f}, {0.0f, 0.0f, -1.0f}, {0.0f, 0.0f}},
+		{{0.5f, -0.5f, -0.5f}, {0.0f, 0.0f, -1.0f}, {1.0f, 0.0f}},
+		{{0.5f, 0.5f, -0.5f}, {0.0f, 0.0f, -1.0f}, {1.0f, 1.0f}},
+		{{-0.5f, 0.5f, -0.5f}, {0.0f, 0.0f, -1.0f}, {0.0f, 1.0f}},
+		{{-0.5f, -0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f}},
+		{{0.5f, -0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}, {1.0f, 0.0f}},
+		{{0.5f, 0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}, {1.0f, 1.0f}},
+		{{-0.5f, 0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}, {0.0f, 1.0f}},
+		{{-0.5f, 0.5f, 0.5f}, {-1.0f, 0.0f, 0.0f}, {1.0f, 0.0f}},
+		{{-0.5f, 0.5f, -0.5f}, {-1.0f, 0.0f, 0.0f}, {1.0f, 1.0f}},
+		{{-0.5f, -0.5f, -0.5f}, {-1.0f, 0.0f, 0.0f}, {0.0f, 1.0f}},
+		{{-0.5f, -0.5f, 0.5f}, {-1.0f, 0.0f, 0.0f}, {0.0f, 0.0f}},
+		{{0.5f, 0.5f, 0.5f}, {1.0f, 0.0f, 0.0f}, {1.0f, 0.0f}},
+		{{0.5f, 0.5f, -0.5f}, {1.0f, 0.0f, 0.0f}, {1.0f, 1.0f}},
+		{{0.5f, -0.5f, -0.5f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f}},
+		{{0.5f, -0.5f, 0.5f}, {1.0f, 0.0f, 0.0f}, {0.0f, 0.0f}},
+		{{-0.5f, -0.5f, -0.5f}, {0.0f, -1.0f, 0.0f}, {0.0f, 1.0f}},
+		{{0.5f, -0.5f, -0.5f}, {0.0f, -1.0f, 0.0f}, {1.0f, 1.0f}},
+		{{0.5f, -0.5f, 0.5f}, {0.0f, -1.0f, 0.0f}, {1.0f, 0.0f}},
+		{{-0.5f, -0.5f, 0.5f}, {0.0f, -1.0f, 0.0f}, {0.0f, 0.0f}},
+		{{-0.5f, 0.5f, -0.5f}, {0.0f, 1.0f, 0.0f}, {0.0f, 1.0f}},
+		{{0.5f, 0.5f, -0.5f}, {0.0f, 1.0f, 0.0f}, {1.0f, 1.0f}},
+		{{0.5f, 0.5f, 0.5f}, {0.0f, 1.0f, 0.0f}, {1.0f, 0.0f}},
+		{{-0.5f, 0.5f, 0.5f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f}}
+	};
+	std::vector<unsigned int> cubeIndices;
+	for (unsigned int face = 0; face < 6; face++) {
+		unsigned int base = face * 4;
+		cubeIndices.insert(cubeIndices.end(), {base, base + 1, base + 2, base + 2, base + 3, base});
+	}
+
+	Mesh cubeMesh(cubeVertices, cubeIndices, {{diffuseMap, "diffuse"}, {specularMap, "specular"}});
+	cubeMesh.printStats("Cube mesh");
+
+	// scene content lives in the entity store; the containers share one instance batch
+	EntityStore scene;
+	for (const glm::vec3 &position : cubePositions) {
+		Entity container = scene.create(TransformComponent | BoundsComponent | RenderableComponent | InstancedComponent);
+		scene.setTransform(container, position);
+		scene.setBounds(container, glm::vec3(0.0f), 0.87f);		// half the cube diagonal
+		scene.renderable(container) = Renderable{&cubeMesh, &shader};
+		scene.instanced(container).batch = CONTAINER_BATCH;
+	}
+
+	// point light circling the containers, drawn as a small white cube
+	Entity lamp = scene.create(TransformComponent | BoundsComponent | RenderableComponent | PointLightComponent | OrbitComponent);
+	scene.setBounds(lamp, glm::vec3(0.0f), 0.87f);
+	scene.renderable(lamp) = Renderable{&cubeMesh, &lightShader};
+	scene.orbit(lamp) = Orbit{glm::vec3(0.0f, 1.0f, 0.0f), 10.0f, glm::radians(180.0f)};
+	PointLight &lampLight = scene.pointLight(lamp);
+	lampLight.ambient = glm::vec3(0.02f, 0.02f, 0.02f);
+	lampLight.diffuse = glm::vec3(0.6f, 0.6f, 0.6f);
+	lampLight.specular = glm::vec3(0.2f, 0.2f, 0.2f);
+	lampLight.constant = 1.0f;
+	lampLight.linear = 0.027f;
+	lampLight.quadratic = 0.0028f;
+	updateOrbits(scene, 0.0f);										// simulation state at time zero
+
+	// per-instance transforms of every container, drawn with a single call
+	updateTransforms(scene);
+	std::vector<InstanceData> cubeInstances;
+	gatherInstances(scene, CONTAINER_BATCH, cubeInstances);
+
+	InstanceBuffer cubeInstanceBuffer;
+	cubeInstanceBuffer.upload(cubeInstances.data(), cubeInstances.size());
+	cubeInstanceBuffer.attach(cubeMesh.getVAO());
+
+	// on 4.3 the containers are frustum culled on the GPU and drawn with one multi-draw
+	std::unique_ptr<IndirectDrawList> cubeDraws;
+	if (glExtensions.multiDrawIndirect) {
+		cubeDraws = std::make_unique<IndirectDrawList>(CULL_SHADER_PATH);
+		cubeDraws->build(cubeMesh, cubeInstances.data(), cubeInstances.size());
+	}
+
+    shaderCompiler.finish();
+    programCache.printStats();
 	
     shader.use();
 	
-	// set material properties
-	shader.setInt("material.diffuse", 0);
-	shader.setInt("material.specular", 1);
+	// set material properties, the samplers are set by Mesh::Draw; lights come from the LightBlock
 	shader.setFloat("material.shininess", 32.0f);
 
-	// set light properties
-	shader.setVec3("pointLight.ambient", glm::vec3(0.02f, 0.02f, 0.02f));
-	shader.setVec3("pointLight.diffuse", glm::vec3(0.6f, 0.6f, 0.6f));
-	shader.setVec3("pointLight.specular", glm::vec3(0.2f, 0.2f, 0.2f));
-	shader.setFloat("pointLight.constant", 1.0f);
-	shader.setFloat("pointLight.linear", 0.027f);
-	shader.setFloat("pointLight.quadratic", 0.0028f);
-
-	// set directional light properties
-	shader.setVec3("dirLight.direction", glm::vec3(-0.5f, -0.5f, -0.5f));
-	shader.setVec3("dirLight.ambient", glm::vec3(0.01f, 0.01f, 0.01f));
-	shader.setVec3("dirLight.diffuse", glm::vec3(0.4f, 0.4f, 0.4f));
-	shader.setVec3("dirLight.specular", glm::vec3(0.05f, 0.05f, 0.05f));
-
-	// set spot light properties
-	shader.setVec3("spotLight.ambient", glm::vec3(0.0f, 0.0f, 0.0f));
-	shader.setVec3("spotLight.diffuse", glm::vec3(1.0f, 1.0f, 1.0f));
-	shader.setVec3("spotLight.specular", glm::vec3(1.0f, 1.0f, 1.0f));
-	shader.setFloat("spotLight.constant", 1.0f);
-	shader.setFloat("spotLight.linear", 0.027f);
-	shader.setFloat("spotLight.quadratic", 0.0028f);
-
-    float prevTime = glfwGetTime();
-    float deltaTime = 0.0f;
-    float angle = 0.0f;
-    float rotationSpeed = glm::radians(180.0f); 					// 90 degrees per second
-	float radius = 10.0f;
-
+    // headless runs advance a fixed timestep per frame so every run renders the same frames; time is
+    // counted in whole clock ticks, so equal frames always run the same number of simulation steps
+    int frameIndex = 0;
+    int totalFrames = options.warmupFrames + options.frames;
+    uint64_t ticksPerSecond = options.headless ? 1000000000ull : glfwGetTimerFrequency();
+    uint64_t headlessFrameTicks = (uint64_t)std::llround(options.timestep * 1e9);
+    auto currentTicks = [&]() {
+        return options.headless ? (uint64_t)frameIndex * headlessFrameTicks : glfwGetTimerValue();
+    };
+
+    // the output is the window, or an offscreen target standing in for it when headless
+    std::unique_ptr<Framebuffer> offscreen;
+    int outputWidth = options.width, outputHeight = options.height;
+    if (options.headless)
+        offscreen = std::make_unique<Framebuffer>(options.width, options.height);
+    else
+        glfwGetFramebufferSize(window, &outputWidth, &outputHeight);
+
+    // the scene is rendered at whatever resolution keeps the GPU within the budget, then upscaled
+    DynamicResolution resolution(VERTEX_SHADER_UPSCALE_PATH, FRAGMENT_SHADER_UPSCALE_PATH,
+                                 outputWidth, outputHeight, options.budget);
+    GPUFrameTimer gpuTimer;
+    BenchmarkReport report;
+
+    // the report keeps the GPU times of measured frames only; a frame whose query was dropped has none
+    auto reportGPUTimes = [&](const std::vector<double> &milliseconds, const std::vector<int> &frames) {
+        for (size_t i = 0; i < milliseconds.size(); i++)
+            if (frames[i] >= options.warmupFrames)
+                report.gpuMilliseconds.push_back(milliseconds[i]);
+    };
+
+    uint64_t prevTicks = currentTicks();
+    FixedTimestep simulation(ticksPerSecond, SIMULATION_RATE, MAX_SIMULATION_STEPS);
+
+    // the simulation moves its own camera position; the camera shows it blended between steps
+    glm::vec3 cameraPosition = camera.getPosition();
+    glm::vec3 previousCameraPosition = cameraPosition;
     glEnable(GL_DEPTH_TEST); 										// enable depth testing
 
-    while (!glfwWindowShouldClose(window)) {
-
-        deltaTime = glfwGetTime() - prevTime;
-        prevTime = glfwGetTime();
-
-        float cameraAngle = (float) glfwGetTime() * rotationSpeed;
-		
-        glm::mat4 view = camera.calculateLookAt();
-        glm::mat4 perspective = glm::perspective(
-            glm::radians(camera.getZoom()),
-            (float)WINDOW_WIDTH / (float)WINDOW_HEIGHT, 0.1f, 100.0f
-		);
-
-        shader.use();
-        shader.setMat4("view", view);
-        shader.setMat4("projection", perspective);
-
-        // check if the escape key was pressed or the window was closed
-        processInput(window, deltaTime);
-
-        // rendering commands here
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-		glm::vec3 lightPos = glm::vec3(radius * cos(cameraAngle), 1.0f, radius * sin(cameraAngle));
-        glm::mat4 model = glm::mat4(1.0f);
-		model = glm::translate(model, lightPos);
-		
-        lightShader.use();
-        lightShader.setMat4("model", model);
-        lightShader.setMat4("view", view);
-        lightShader.setMat4("projection", perspective);
-        glBindVertexArray(lightVAO);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-
-        shader.use();
-		shader.setVec3("viewPos", camera.CameraPos);
-		shader.setVec3("spotLight.position", camera.CameraPos);
-		shader.setVec3("spotLight.direction", camera.CameraFront);
-		shader.setFloat("spotLight.cutOff", glm::cos(glm::radians(12.5f)));
-		shader.setVec3("pointLight.position", lightPos);
-
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, diffuseMap);
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, specularMap);
-        glBindVertexArray(VAO);
-        for (unsigned int i = 0; i < 10; i++) {
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, cubePositions[i]);
-            shader.setMat4("model", model);
-            shader.setMat3("normalMatrix", glm::mat3(glm::transpose(glm::inverse(model))));
-            glDrawArrays(GL_TRIANGLES, 0, 36); // update buffers
+    // the per-frame light block, and on 3.3 the container instances, are written straight into
+    // mapped memory; the camera block only changes with the camera
+    UploadRing uploadRing(16 * 1024 + cubeInstances.size() * sizeof(InstanceData));
+    CameraBuffer cameraBuffer;
+
+	// draws are collected each frame and issued sorted by state and depth
+	RenderQueue renderQueue(0.1f, 100.0f);
+
+    // the main thread simulates the next frame while the render thread draws the last one;
+    // snapshots of the scene are all they share, apart from the window title
+    SnapshotBuffer<FrameSnapshot> snapshots;
+    std::mutex titleMutex;
+    std::string pendingTitle;
+
+    // from here on the context belongs to the render thread
+    if (window)
+        glfwMakeContextCurrent(NULL);
+    else
+        headlessContext.release();
+
+    std::thread renderThread([&]() {
+        PROFILE_THREAD("Render");
+        if (window)
+            glfwMakeContextCurrent(window);
+        bool contextCurrent = window || headlessContext.makeCurrent();
+
+        std::vector<double> gpuFrameTimes;
+        std::vector<int> gpuFrames;
+        double lastStatsReport = window ? glfwGetTime() : 0.0;
+        auto lastFrameEnd = std::chrono::steady_clock::now();
+
+        while (true) {
+            const FrameSnapshot &frame = snapshots.acquire();
+            if (frame.quit)
+                break;
+            if (!contextCurrent)
+                continue;                                   // keep taking snapshots so the main thread finishes
+
+            if (frame.capture)
+                PROFILE_CAPTURE(options.traceFrames, options.trace.empty() ? "trace.json" : options.trace);
+            PROFILE_FRAME();
+            PROFILE_SCOPE("Render");
+
+            // programs submitted after start-up, e.g. a new permutation, finish as the driver completes
+            // them instead of stalling their first use()
+            shaderCompiler.update();
+
+            glState.beginFrame();
+            resolution.resize(frame.outputWidth, frame.outputHeight);
+
+            // one upload of each block, shared by every program
+            UploadRing::Allocation containerInstances;
+            {
+                PROFILE_SCOPE("Upload");
+                cameraBuffer.update(frame.cameraVersion, frame.view, frame.projection, frame.cameraPosition);
+                uploadRing.beginFrame();
+                LightBlock *lightBlock = uploadRing.allocateUniformBlock<LightBlock>(LIGHT_BLOCK_BINDING);
+                if (lightBlock)
+                    *lightBlock = frame.lights;
+                if (!cubeDraws) {
+                    containerInstances = uploadRing.allocate(frame.containerInstances.size() * sizeof(InstanceData), 16);
+                    if (containerInstances.data)
+                        memcpy(containerInstances.data, frame.containerInstances.data(), containerInstances.size);
+                }
+                uploadRing.finishWrites();
+            }
+
+            gpuTimer.begin(frame.frameIndex);
+            resolution.beginScene();
+
+            // rendering commands here
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            for (const CommandBuffer &buffer : frame.commands)
+                renderQueue.append(buffer);
+            if (cubeDraws) {
+                PROFILE_GPU_SCOPE("Cull");
+                cubeDraws->cull();
+                renderQueue.submitIndirect(RenderPass::Opaque, shader, cubeMesh, *cubeDraws, frame.nearestContainer);
+            } else {
+                // instanced draws have no base instance on 3.3, so the attributes move to this frame's instances
+                if (containerInstances.data) {
+                    InstanceBuffer::attach(cubeMesh.getVAO(), uploadRing.ID, containerInstances.offset);
+                } else {
+                    cubeInstanceBuffer.upload(frame.containerInstances.data(), frame.containerInstances.size(), GL_STREAM_DRAW);
+                    cubeInstanceBuffer.attach(cubeMesh.getVAO());
+                }
+                renderQueue.submitInstanced(RenderPass::Opaque, shader, cubeMesh, frame.containerInstances.size(), frame.nearestContainer);
+            }
+            renderQueue.flush();
+            {
+                PROFILE_GPU_SCOPE("Upscale");
+                resolution.present(offscreen ? offscreen->ID : 0);
+            }
+            uploadRing.endFrame();
+
+            gpuTimer.end();
+            gpuFrameTimes.clear();
+            gpuFrames.clear();
+            gpuTimer.collect(gpuFrameTimes, gpuFrames);
+            resolution.update(gpuFrameTimes);
+            if (options.headless)
+                reportGPUTimes(gpuFrameTimes, gpuFrames);
+
+            // show how many state changes and uniform uploads were filtered out, once per second;
+            // the title itself is set by the main thread
+            if (window && glfwGetTime() - lastStatsReport >= 1.0) {
+                const GLStateCache::Stats &stats = glState.lastFrame();
+                const RenderQueue::Stats &queueStats = renderQueue.lastFlush();
+                const UploadRing::Stats &uploadStats = uploadRing.lastFrame();
+                char title[320];
+                snprintf(title, sizeof(title), "OpenGL Window - %dx%d (%.0f%%, %.2f ms GPU), %u draws, %u program changes, binds %u issued / %u elided, uniforms %u issued / %u elided, %zu bytes uploaded, %.3f ms fence wait",
+                         resolution.renderWidth(), resolution.renderHeight(), resolution.scale() * 100.0f,
+                         resolution.gpuMilliseconds(), queueStats.commands, queueStats.programChanges,
+                         stats.issued, stats.elided, stats.uniformsIssued, stats.uniformsElided,
+                         uploadStats.bytesUploaded, uploadStats.fenceWaitSeconds * 1000.0);
+                std::lock_guard<std::mutex> lock(titleMutex);
+                pendingTitle = title;
+                lastStatsReport = glfwGetTime();
+            }
+
+            if (window) {
+                PROFILE_SCOPE("Swap");
+                glfwSwapBuffers(window);
+            }
+
+            // frames complete at the pace of the slower thread; warm-up frames are not counted
+            auto frameEnd = std::chrono::steady_clock::now();
+            std::chrono::duration<double, std::milli> frameTime = frameEnd - lastFrameEnd;
+            lastFrameEnd = frameEnd;
+            if (options.headless && frame.frameIndex >= options.warmupFrames)
+                report.cpuMilliseconds.push_back(frameTime.count());
+        }
+
+        // hand the context back for the cleanup
+        if (window)
+            glfwMakeContextCurrent(NULL);
+        else
+            headlessContext.release();
+    });
+
+    bool captureKeyDown = false;
+    PROFILE_THREAD("Main");
+
+    while (options.headless ? frameIndex < totalFrames : !glfwWindowShouldClose(window)) {
+        PROFILE_SCOPE("Simulate");
+
+        FrameSnapshot &frame = snapshots.back();
+        frame.frameIndex = frameIndex;
+
+        // a headless trace covers the first measured frames
+        frame.capture = options.headless && frameIndex == options.warmupFrames && !options.trace.empty();
+
+        // check if the escape key was pressed or the window was closed; F2 records a profiler trace
+        if (window) {
+            glfwPollEvents();
+            // the callbacks are the producer; anything held back by a full ring gets another chance
+            inputEvents.flush();
+            bool captureKey = glfwGetKey(window, GLFW_KEY_F2) == GLFW_PRESS;
+            frame.capture = captureKey && !captureKeyDown;
+            captureKeyDown = captureKey;
+
+            // follow window resizes; a minimized window keeps the last size
+            int width, height;
+            glfwGetFramebufferSize(window, &width, &height);
+            if (width > 0 && height > 0) {
+                outputWidth = width;
+                outputHeight = height;
+            }
+        }
+        frame.outputWidth = outputWidth;
+        frame.outputHeight = outputHeight;
+
+        // read after polling, so every event queued so far is stamped no later than the frame
+        uint64_t ticks = currentTicks();
+        simulation.accumulate(ticks - prevTicks);
+        prevTicks = ticks;
+        double time = (double)ticks / (double)ticksPerSecond;
+
+        // as many fixed steps as the real time since the last frame covers, none when drawing faster
+        while (simulation.step()) {
+            PROFILE_SCOPE("Step");
+            saveTransforms(scene);
+            previousCameraPosition = cameraPosition;
+            // each step takes the input up to the real time it ends at: the frame time less what is still accumulated
+            camera.processEvents(inputEvents, time - simulation.alpha() * simulation.stepSeconds());
+            if (window)
+                processInput(window, (float)simulation.stepSeconds(), cameraPosition);
+            updateOrbits(scene, (float)simulation.time());
+        }
+        float alpha = simulation.alpha();
+        camera.setPosition(previousCameraPosition + (cameraPosition - previousCameraPosition) * alpha);
+
+        // the matrices are only rebuilt when the camera moved or the output was resized
+        camera.setAspect((float)outputWidth / (float)outputHeight);
+        frame.view = camera.getView();
+        frame.projection = camera.getProjection();
+        frame.cameraPosition = camera.getPosition();
+        frame.cameraVersion = camera.version();
+
+        // scene systems, each a linear pass over the entity columns
+        {
+            PROFILE_SCOPE("Update");
+            updateTransforms(scene, alpha);
+            updateBounds(scene);
+            cullBounds(scene, camera.getFrustum(), camera.version());
+        }
+
+        setLights(frame.lights);
+        writePointLights(scene, frame.lights);
+
+		// the instanced containers are ordered by the nearest one
+		frame.nearestContainer = nearestInBatch(scene, CONTAINER_BATCH, camera.getPosition(), 100.0f);
+		if (!cubeDraws) {
+			// without GPU culling only the containers culled on the CPU are uploaded and drawn
+			frame.containerInstances.clear();
+			gatherInstances(scene, CONTAINER_BATCH, frame.containerInstances);
+		}
+		frame.commands.resize(jobs.threadCount());
+		for (CommandBuffer &buffer : frame.commands)
+			buffer.clear();
+		recordRenderables(scene, camera.getPosition(), frame.commands);
+
+        {
+            PROFILE_SCOPE("Publish");
+            snapshots.publish();
+        }
+
+        if (window) {
+            std::lock_guard<std::mutex> lock(titleMutex);
+            if (!pendingTitle.empty()) {
+                glfwSetWindowTitle(window, pendingTitle.c_str());
+                pendingTitle.clear();
+            }
         }
+        frameIndex++;
+    }
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+    snapshots.back().quit = true;
+    snapshots.publish();
+    renderThread.join();
+
+    if (window)
+        glfwMakeContextCurrent(window);
+    else
+        headlessContext.makeCurrent();
+
+    if (options.headless) {
+        glFinish();
+        std::vector<double> gpuFrameTimes;
+        std::vector<int> gpuFrames;
+        gpuTimer.collect(gpuFrameTimes, gpuFrames, true);
+        reportGPUTimes(gpuFrameTimes, gpuFrames);
+
+        report.resolutionScale = resolution.scale();
+        report.print(options);
+        if (gpuTimer.dropped() > 0)
+            std::cout << "GPU timer: " << gpuTimer.dropped() << " frames dropped with their query still pending" << std::endl;
+        std::cout << "Simulation: " << simulation.steps() << " steps at " << SIMULATION_RATE << " Hz, "
+                  << simulation.droppedFrames() << " frames over " << MAX_SIMULATION_STEPS << " steps" << std::endl;
+        if (!options.output.empty())
+            report.write(options.output, options);
     }
 
     // cleanup
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
+    PROFILE_SHUTDOWN();
+    glState.invalidate();
+    cubeMesh.deleteMesh();
+    cubeInstanceBuffer.deleteBuffer();
+    if (cubeDraws) {
+        cubeDraws->deleteBuffers();
+    }
 
-    glDeleteVertexArrays(1, &lightVAO);
 	glDeleteTextures(1, &diffuseMap);
 	glDeleteTextures(1, &specularMap);
 
-    shader.deleteShader();
+    litShaders.deleteShaders();
     lightShader.deleteShader();
+    uploadRing.deleteBuffer();
+    cameraBuffer.deleteBuffer();
+    resolution.deleteResources();
+    gpuTimer.deleteQueries();
+    if (offscreen) {
+        offscreen->deleteFramebuffer();
+    }
 
-    glfwTerminate();
+    jobs.stop();
+    if (window)
+        glfwTerminate();
+    else
+        headlessContext.destroy();
     return 0;
 }
 
-void processInput(GLFWwindow *window, float deltaTime) {
+void processInput(GLFWwindow *window, float deltaTime, glm::vec3 &cameraPosition) {
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
         glfwSetWindowShouldClose(window, true);
     }
 
     float cameraSpeed = 10.0f * deltaTime;
     if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) {
-        camera.CameraPos += camera.CameraFront * cameraSpeed;
+        cameraPosition += camera.getFront() * cameraSpeed;
     }
     if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) {
-        camera.CameraPos -= camera.CameraFront * cameraSpeed;
+        cameraPosition -= camera.getFront() * cameraSpeed;
     }
     if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) {
-        camera.CameraPos -=
-            glm::normalize(glm::cross(camera.CameraFront, camera.CameraUp)) *
-            cameraSpeed;
+        cameraPosition -= camera.getRight() * cameraSpeed;
     }
     if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) {
-        camera.CameraPos +=
-            glm::normalize(glm::cross(camera.CameraFront, camera.CameraUp)) *
-            cameraSpeed;
+        cameraPosition += camera.getRight() * cameraSpeed;
     }
 }
 
-void framebufferSizeCallback(GLFWwindow *window, int width, int height) {
-    glViewport(0, 0, width, height);
+// seconds on the timer the frame loop counts ticks of, so events compare with the simulation steps
+double eventTime() {
+    return (double)glfwGetTimerValue() / (double)glfwGetTimerFrequency();
 }
 
 void mouseCallback(GLFWwindow *window, double xpos, double ypos) {
-    camera.mouseCallback(window, xpos, ypos);
+    inputEvents.push(InputEvent{InputEvent::Type::CursorPosition, eventTime(), xpos, ypos});
 }
 
 void scrollCallback(GLFWwindow *window, double xoffset, double yoffset) {
-    camera.scrollCallback(window, xoffset, yoffset);
+    inputEvents.push(InputEvent{InputEvent::Type::Scroll, eventTime(), xoffset, yoffset});
 }
 
-unsigned int loadTexture(const std::string &path) {
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    int width, height, nrChannels;
-    unsigned char *data = stbi_load(path.c_str(), &width, &height, &nrChannels, 0);
-    if (data) {
-        GLenum format = (nrChannels == 4) ? GL_RGBA : GL_RGB;
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-        stbi_image_free(data);
-    } else {
-        std::cout << "Failed to load texture: " << path << " - " << stbi_failure_reason() << std::endl;
-        glDeleteTextures(1, &textureID);
-        return 0;
-    }
+void loadTextureAsync(const std::string &path, unsigned int &texture, JobCounter &loaded) {
+    jobs.schedule(loaded, [&path, &texture, &loaded]() {
+        int width, height, nrChannels;
+        unsigned char *data = stbi_load(path.c_str(), &width, &height, &nrChannels, 0);
+        if (!data) {
+            std::cout << "Failed to load texture: " << path << " - " << stbi_failure_reason() << std::endl;
+            return;
+        }
 
-    return textureID;
-}
\ No newline at end of file
+        // the upload needs the context, so it is handed to the main thread
+        jobs.scheduleMainThread(loaded, [&texture, data, width, height, nrChannels]() {
+            glGenTextures(1, &texture);
+            glState.bindTexture(0, GL_TEXTURE_2D, texture);
+
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+            GLenum format = (nrChannels == 4) ? GL_RGBA : GL_RGB;
+            glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+            glGenerateMipmap(GL_TEXTURE_2D);
+            stbi_image_free(data);
+        });
+    });
+}
+
+void setLights(LightBlock &lights) {
+    // point lights come from the scene, see writePointLights
+
+    // directional light
+    lights.dirLight.direction = glm::vec3(-0.5f, -0.5f, -0.5f);
+    lights.dirLight.ambient = glm::vec3(0.01f, 0.01f, 0.01f);
+    lights.dirLight.diffuse = glm::vec3(0.4f, 0.4f, 0.4f);
+    lights.dirLight.specular = glm::vec3(0.05f, 0.05f, 0.05f);
+
+    // spot light held by the camera
+    lights.spotLight.position = camera.getPosition();
+    lights.spotLight.direction = camera.getFront();
+    lights.spotLight.cutOff = glm::cos(glm::radians(12.5f));
+    lights.spotLight.ambient = glm::vec3(0.0f, 0.0f, 0.0f);
+    lights.spotLight.diffuse = glm::vec3(1.0f, 1.0f, 1.0f);
+    lights.spotLight.specular = glm::vec3(1.0f, 1.0f, 1.0f);
+    lights.spotLight.constant = 1.0f;
+    lights.spotLight.linear = 0.027f;
+    lights.spotLight.quadratic = 0.0028f;
+}